@@ -501,8 +501,7 @@ void big_int::alloc_number
 void big_int::free_number()
 {
     if(!number)return;
-    number->refs--;
-    if(number->refs)return;
+    if(ARAGELI_BIG_INT_REFS_DEC(number->refs))return;
     free_data(number->data);
     delete number;
     number = 0;
@@ -616,7 +615,7 @@ big_int& big_int::operator= (const big_int & b)
     if(number == b.number)
         return *this;
     free_number();
-    b.number->refs++;
+    ARAGELI_BIG_INT_REFS_INC(b.number->refs);
     number = b.number;
     return *this;
 }
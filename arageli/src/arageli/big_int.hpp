@@ -56,6 +56,25 @@
 
 #include "std_import.hpp"
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/// Atomic change of the link counter of big_int representation.
+/** Copies of one number share the representation, so the counter is
+    changed atomically: copies of a number (for example the factory<big_int>
+    unit and null objects) may be made and destroyed in several threads. */
+#if defined(__GNUC__)
+    #define ARAGELI_BIG_INT_REFS_INC(REFS) __sync_add_and_fetch(&(REFS), 1)
+    #define ARAGELI_BIG_INT_REFS_DEC(REFS) __sync_sub_and_fetch(&(REFS), 1)
+#elif defined(_MSC_VER)
+    #define ARAGELI_BIG_INT_REFS_INC(REFS) _InterlockedIncrement(reinterpret_cast<volatile long*>(&(REFS)))
+    #define ARAGELI_BIG_INT_REFS_DEC(REFS) _InterlockedDecrement(reinterpret_cast<volatile long*>(&(REFS)))
+#else
+    #define ARAGELI_BIG_INT_REFS_INC(REFS) (++(REFS))
+    #define ARAGELI_BIG_INT_REFS_DEC(REFS) (--(REFS))
+#endif
+
 /**
     \file big_int.hpp.
     \brief Big integer number class implementation.
@@ -177,7 +196,7 @@ public:
     big_int (const big_int& b)
     {
         ARAGELI_ASSERT_0(this != &b);
-        b.number->refs++;
+        ARAGELI_BIG_INT_REFS_INC(b.number->refs);
         number = b.number;
     }
 
@@ -906,7 +925,7 @@ inline big_int& operator>>= (big_int& a, std::size_t b)
     {
         if(a.number->refs > 1)
         {
-            a.number->refs--;
+            ARAGELI_BIG_INT_REFS_DEC(a.number->refs);
             big_int::digit* newdata = big_int::get_mem_for_data(1);
             *newdata = *a.number->data;
             a.alloc_number(a.number->sign, newdata, 1);
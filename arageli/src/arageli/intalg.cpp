@@ -42,6 +42,7 @@
 #if !defined(ARAGELI_INCLUDE_CPP_WITH_EXPORT_TEMPLATE) ||    \
     defined(ARAGELI_INCLUDE_CPP_WITH_EXPORT_TEMPLATE_INTALG)
 
+#include <algorithm>
 #include <utility>
 #include <stack>
 #include <vector>
@@ -87,6 +88,92 @@ T power_mod (T a, I n, const T& m, const T_factory& tfctr)
 }
 
 
+namespace _Internal
+{
+
+/// Splits n into right-to-left sliding windows of at most width bits.
+/** digits[i] is an odd window value starting at bit i or 0,
+    n == sum(digits[i] * 2^i). */
+template <typename I>
+void sliding_windows (I n, std::size_t width, std::vector<unsigned int>& digits)
+{
+    std::vector<bool> bits;
+    while(!is_null(n))
+    {
+        bits.push_back(is_odd(n));
+        n >>= 1;
+    }
+
+    digits.assign(bits.size(), 0);
+    for(std::size_t i = 0; i < bits.size();)
+    {
+        if(!bits[i])
+        {
+            ++i;
+            continue;
+        }
+        unsigned int value = 0;
+        for(std::size_t j = 0; j < width && i + j < bits.size(); ++j)
+            if(bits[i + j])
+                value |= 1u << j;
+        digits[i] = value;
+        i += width;
+    }
+}
+
+/// Odd powers a, a^3, ..., a^(2^width - 1) modulo m.
+template <typename T>
+void odd_powers_mod (const T& a, std::size_t width, const T& m, std::vector<T>& powers)
+{
+    powers.assign(std::size_t(1) << (width - 1), a % m);
+    T square = powers[0]*powers[0] % m;
+    for(std::size_t i = 1; i < powers.size(); ++i)
+        powers[i] = powers[i - 1]*square % m;
+}
+
+}
+
+
+template <typename T, typename I, typename T_factory>
+T power_mod_dual (const T& a, I n, const T& b, I k, const T& m, const T_factory& tfctr)
+{
+    ARAGELI_ASSERT_0(!is_negative(n) && !is_negative(k));
+    ARAGELI_ASSERT_0(is_positive(m));
+
+    const std::size_t width = 4;
+    std::vector<unsigned int> ndigits, kdigits;
+    _Internal::sliding_windows(n, width, ndigits);
+    _Internal::sliding_windows(k, width, kdigits);
+
+    std::vector<T> apowers, bpowers;
+    if(!ndigits.empty())
+        _Internal::odd_powers_mod(a, width, m, apowers);
+    if(!kdigits.empty())
+        _Internal::odd_powers_mod(b, width, m, bpowers);
+
+    T res = tfctr.unit(a);
+    bool started = false;
+    for(std::size_t i = std::max(ndigits.size(), kdigits.size()); i > 0; --i)
+    {
+        std::size_t pos = i - 1;
+        if(started)
+            res = res*res % m;
+        if(pos < ndigits.size() && ndigits[pos])
+        {
+            res = res*apowers[ndigits[pos]/2] % m;
+            started = true;
+        }
+        if(pos < kdigits.size() && kdigits[pos])
+        {
+            res = res*bpowers[kdigits[pos]/2] % m;
+            started = true;
+        }
+    }
+
+    return res % m;
+}
+
+
 namespace _Internal
 {
 
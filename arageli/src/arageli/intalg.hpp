@@ -95,6 +95,22 @@ inline T power_mod (const T& a, const I& n, const T& m)
     return power_mod(a, n, m, factory<T>());
 }
 
+/// Computes a^n * b^k modulo m with one common chain of squarings.
+/** Both exponents are split into sliding windows of odd values and the
+    precomputed odd powers of a and b are multiplied in while a single
+    result is squared (Shamir's trick with interleaved windows).
+    Requirements: n and k must be non-negative, m must be positive. */
+template <typename T, typename I, typename T_factory>
+T power_mod_dual (const T& a, I n, const T& b, I k, const T& m, const T_factory& tfctr);
+
+/// Computes a^n * b^k modulo m with one common chain of squarings.
+/** Requirements: n and k must be non-negative, m must be positive. */
+template <typename T, typename I>
+inline T power_mod_dual (const T& a, const I& n, const T& b, const I& k, const T& m)
+{
+    return power_mod_dual(a, n, b, k, m, factory<T>());
+}
+
 
 namespace _Internal
 {
@@ -1,5 +1,9 @@
 #include "function.h"
 
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+
 big_int Function::big_intFromByteArray(const QByteArray &ba)
 {
 	big_int result = 0;
@@ -71,37 +75,165 @@ big_int Function::bin_pow(big_int a, big_int n, big_int m)
 	return result;
 }
 
-big_int Function::modSqrt(const big_int &a, const big_int &p)
+unsigned int Function::bits(const big_int &number, std::size_t position, unsigned int count)
+{
+	std::size_t length = number.length();
+	unsigned int result = 0;
+	for (unsigned int i = 0; i < count && position + i < length; i++)
+	{
+		result |= (number.bit(position + i) ? 1 : 0) << i;
+	}
+	return result;
+}
+
+/// Width-w non-adjacent form of a non-negative number, lowest digit first.
+/** Every non-zero digit is odd and lies in (-2^(w-1), 2^(w-1)),
+	and of any w consecutive digits at most one is non-zero. */
+QVector<int> Function::wnaf(const big_int &number, unsigned int width)
 {
-	big_int b;
-	do
+	std::size_t length = number.length();
+	const int modulus = 1 << width;
+	const int half = 1 << (width - 1);
+
+	QVector<int> result;
+	result.reserve(length + 1);
+
+	int window = bits(number, 0, width);
+	std::size_t position = 0;
+	while (window != 0 || position + width < length)
 	{
-		b = big_int::random_with_length(255);
-	} while (Function::legendre(b, p) == 1);
+		int digit = 0;
+		if (window & 1)
+		{
+			digit = (window >= half) ? window - modulus : window;
+			window -= digit;
+		}
+		result.append(digit);
+		window >>= 1;
+		position++;
+		if (position + width - 1 < length && number.bit(position + width - 1))
+		{
+			window += half;
+		}
+	}
+	return result;
+}
 
-	big_int s = 0;
+/// Square root of a modulo an odd prime p, false if a is not a square.
+/** p = 3 (mod 4) and p = 5 (mod 8) (Atkin) take a single exponentiation,
+	other primes go through Tonelli-Shanks. The root is checked by squaring,
+	so a non-residue or a composite p is reported instead of giving a wrong value. */
+bool Function::modSqrt(const big_int &a, const big_int &p, big_int &root)
+{
+	big_int value = mod(a, p);
+	if (value.is_null())
+	{
+		root = value;
+		return true;
+	}
+
+	unsigned int low = bits(p, 0, 3);
+	if ((low & 3) == 3)
+	{
+		root = power_mod(value, (p + 1) >> 2, p);
+	}
+	else if (low == 5)
+	{
+		big_int twice = (value << 1) % p;
+		big_int v = power_mod(twice, (p - 5) >> 3, p);
+		big_int i = (twice * v % p) * v % p;
+		root = mod(value * v % p * (i - 1), p);
+	}
+	else if (!tonelliShanks(value, p, root))
+	{
+		return false;
+	}
+	return root * root % p == value;
+}
+
+bool Function::tonelliShanks(const big_int &a, const big_int &p, big_int &root)
+{
+	int s = 0;
 	big_int t = p - 1;
 	while (!t.is_odd())
 	{
 		s++;
 		t = t >> 1;
 	}
-	big_int inv_a = inverse_mod(a, p);
-	big_int c = power_mod(b, t, p);
-	big_int r = power_mod(a, (t + 1) / 2, p);
-	big_int d = 0;
-	for (int i = 1; i < s; i++)
+
+	big_int z;
+	if (!nonResidue(p, z))
+	{
+		return false;
+	}
+	big_int c = power_mod(z, t, p);
+	big_int r = power_mod(a, (t + 1) >> 1, p);
+	big_int x = power_mod(a, t, p);
+	while (x != 1)
 	{
-		big_int tmp = 2;
-		tmp = power_mod(tmp, s - i - 1, p);
-		d = power_mod(power_mod(r, 2, p) * inv_a, tmp, p);
-		if (d == (p - 1))
+		int i = 0;
+		big_int square = x;
+		while (square != 1 && i < s)
+		{
+			square = square * square % p;
+			i++;
+		}
+		if (i == s)
+		{
+			// a is not a quadratic residue
+			return false;
+		}
+
+		big_int e = c;
+		for (int k = 0; k < s - i - 1; k++)
 		{
-			r = (r * c) % p;
+			e = e * e % p;
 		}
-		c = power_mod(c, 2, p);
+		r = r * e % p;
+		c = e * e % p;
+		x = x * c % p;
+		s = i;
 	}
-	return r;
+	root = r;
+	return true;
+}
+
+/// Smallest quadratic non-residue modulo p, found once per prime.
+/** For a prime p it is below 2 ln^2 p (Bach, under GRH), so the search stops
+	at 2 bits^2. A Legendre symbol other than 1 and p - 1 proves that p is
+	composite and also ends the search. */
+bool Function::nonResidue(const big_int &p, big_int &result)
+{
+	static QMutex mutex;
+	static QMap<QByteArray, big_int> nonResidues;
+
+	QByteArray key = big_intToByteArray(p);
+	{
+		QMutexLocker locker(&mutex);
+		QMap<QByteArray, big_int>::const_iterator cached = nonResidues.constFind(key);
+		if (cached != nonResidues.constEnd())
+		{
+			result = cached.value();
+			return true;
+		}
+	}
+
+	big_int limit = big_int(2 * p.length() * p.length());
+	for (result = 2; result < limit && result < p; result++)
+	{
+		big_int symbol = legendre(result, p);
+		if (symbol == p - 1)
+		{
+			QMutexLocker locker(&mutex);
+			nonResidues.insert(key, result);
+			return true;
+		}
+		if (symbol != 1)
+		{
+			return false;
+		}
+	}
+	return false;
 }
 
 big_int Function::legendre(const big_int &a, const big_int &p)
@@ -109,4 +241,30 @@ big_int Function::legendre(const big_int &a, const big_int &p)
 	return power_mod(a, (p - 1) / 2, p);
 }
 
+/// Inverses of all values modulo m with a single inverse_mod (Montgomery's trick).
+/** Every value must be invertible modulo m. */
+QVector<big_int> Function::inverseModBatch(const QVector<big_int> &values, const big_int &m)
+{
+	QVector<big_int> result(values.size());
+	if (values.isEmpty())
+	{
+		return result;
+	}
 
+	QVector<big_int> products(values.size());
+	big_int product = 1;
+	for (int i = 0; i < values.size(); i++)
+	{
+		product = product * values[i] % m;
+		products[i] = product;
+	}
+
+	big_int inverse = inverse_mod(product, m);
+	for (int i = values.size() - 1; i > 0; i--)
+	{
+		result[i] = inverse * products[i - 1] % m;
+		inverse = inverse * values[i] % m;
+	}
+	result[0] = inverse;
+	return result;
+}
@@ -6,6 +6,7 @@
 using namespace Arageli;
 
 #include <QByteArray>
+#include <QVector>
 
 class Function
 {
@@ -15,9 +16,16 @@ public:
 	static QByteArray big_intToByteArray(const big_int &number);
 	static QByteArray big_intToByteArrayBlock(big_int number, quint32 blockSize);
 	static big_int bin_pow(big_int a, big_int n, big_int m);
+	static unsigned int bits(const big_int &number, std::size_t position, unsigned int count);
+	static QVector<int> wnaf(const big_int &number, unsigned int width);
 
-	static big_int modSqrt(const big_int &a, const big_int &p);
+	static bool modSqrt(const big_int &a, const big_int &p, big_int &root);
 	static big_int legendre(const big_int &a, const big_int &p);
+	static QVector<big_int> inverseModBatch(const QVector<big_int> &values, const big_int &m);
+
+private:
+	static bool tonelliShanks(const big_int &a, const big_int &p, big_int &root);
+	static bool nonResidue(const big_int &p, big_int &result);
 };
 
 #endif // FUNCTION_H
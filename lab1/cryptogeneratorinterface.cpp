@@ -9,6 +9,11 @@ big_int CryptoGeneratorInterface::getParameter(const QByteArray &key)
 	return parameters.value(key, big_int(-1));
 }
 
+QMap<QByteArray, big_int> CryptoGeneratorInterface::getParameters() const
+{
+	return parameters;
+}
+
 void CryptoGeneratorInterface::setParameters(QMap<QByteArray, big_int> newParameters)
 {
 	QListIterator<QByteArray> i(newParameters.keys());
@@ -15,6 +15,7 @@ public:
 
 	virtual void generate() = 0;
 	big_int getParameter(const QByteArray &key);
+	QMap<QByteArray, big_int> getParameters() const;
 	void setParameters(QMap<QByteArray, big_int> newParameters);
 	void setParameter(const QByteArray &key, const big_int &value);
 
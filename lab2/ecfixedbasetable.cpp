@@ -0,0 +1,119 @@
+#include "ecfixedbasetable.h"
+
+#include "ecmultiscalar.h"
+
+#include "function.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+/// The table keeps the curve alive, so its points stay valid after the domain that made it is gone.
+ECFixedBaseTable::ECFixedBaseTable(const EllipticCurvePtr &curve, const ECPoint &point, unsigned int scalarLength)
+	: curve(curve), basePoint(point),
+	  windowCount((scalarLength + windowWidth - 1) / windowWidth)
+{
+	basePoint.curve = curve.data();
+	const int multiplesCount = (1 << windowWidth) - 1;
+	QVector<ECPointJacobian> multiples;
+	multiples.reserve(windowCount * multiplesCount);
+	ECPointJacobian windowBase(basePoint);
+	for (unsigned int i = 0; i < windowCount; i++)
+	{
+		multiples.append(windowBase);
+		for (int j = 1; j < multiplesCount; j++)
+		{
+			multiples.append(multiples.last() + windowBase);
+		}
+		windowBase = multiples.last() + windowBase;
+	}
+
+	QVector<ECPoint> affine = ECPointJacobian::toAffine(multiples);
+	for (unsigned int i = 0; i < windowCount; i++)
+	{
+		windows.append(affine.mid(i * multiplesCount, multiplesCount));
+	}
+	odd = ECMultiScalar::oddMultiples(basePoint, oddWidth);
+}
+
+ECPointJacobian ECFixedBaseTable::multiply(const big_int &x) const
+{
+	if (x.length() > windowCount * windowWidth)
+	{
+		return ECPointJacobian::multiply(x, basePoint);
+	}
+
+	ECPointJacobian result(basePoint.curve);
+
+	for (unsigned int i = 0; i < windowCount; i++)
+	{
+		unsigned int digit = Function::bits(x, i * windowWidth, windowWidth);
+		if (digit)
+		{
+			result += windows[i][digit - 1];
+		}
+	}
+	return result;
+}
+
+const ECPoint &ECFixedBaseTable::point() const
+{
+	return basePoint;
+}
+
+const QVector<ECPoint> &ECFixedBaseTable::oddMultiples() const
+{
+	return odd;
+}
+
+unsigned int ECFixedBaseTable::oddMultiplesWidth()
+{
+	return oddWidth;
+}
+
+/// Shares a table between all domains with the same point while any of them is alive.
+/** The registry keeps only weak references, so a table is freed with its last
+	user. Expired entries are dropped whenever a new table is built. */
+QSharedPointer<const ECFixedBaseTable> ECFixedBaseTable::forPoint(const EllipticCurvePtr &curve, const ECPoint &point,
+																  unsigned int scalarLength)
+{
+	static QMutex mutex;
+	static QMap<QByteArray, QWeakPointer<const ECFixedBaseTable> > tables;
+
+	QByteArray key = pointKey(point);
+	key.append(QByteArray::number(scalarLength));
+
+	QMutexLocker locker(&mutex);
+	QSharedPointer<const ECFixedBaseTable> table = tables.value(key).toStrongRef();
+	if (table.isNull())
+	{
+		QMap<QByteArray, QWeakPointer<const ECFixedBaseTable> >::iterator i = tables.begin();
+		while (i != tables.end())
+		{
+			if (i.value().isNull())
+			{
+				i = tables.erase(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		table = QSharedPointer<const ECFixedBaseTable>(new ECFixedBaseTable(curve, point, scalarLength));
+		tables.insert(key, table);
+	}
+	return table;
+}
+
+QByteArray ECFixedBaseTable::pointKey(const ECPoint &point)
+{
+	QByteArray key = point.curve->key();
+	const big_int values[] = {point.getX(), point.getY()};
+	for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		key.append(Function::big_intToByteArray(values[i]).toHex());
+		key.append(':');
+	}
+	return key;
+}
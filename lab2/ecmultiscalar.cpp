@@ -0,0 +1,88 @@
+#include "ecmultiscalar.h"
+
+#include "ecfixedbasetable.h"
+#include "ecpublickey.h"
+
+#include "function.h"
+
+ECMultiScalar::ECMultiScalar()
+{
+}
+
+void ECMultiScalar::add(const big_int &x, const ECPoint &point)
+{
+	Term term;
+	term.digits = Function::wnaf(x, windowWidth);
+	term.multiples = oddMultiples(point, windowWidth);
+	terms.append(term);
+}
+
+void ECMultiScalar::add(const big_int &x, const ECFixedBaseTable &table)
+{
+	Term term;
+	term.digits = Function::wnaf(x, table.oddMultiplesWidth());
+	term.multiples = table.oddMultiples();
+	terms.append(term);
+}
+
+void ECMultiScalar::add(const big_int &x, const ECPublicKey &key)
+{
+	Term term;
+	term.digits = Function::wnaf(x, key.oddMultiplesWidth());
+	term.multiples = key.oddMultiples();
+	terms.append(term);
+}
+
+ECPointJacobian ECMultiScalar::calculate() const
+{
+	if (terms.isEmpty())
+	{
+		return ECPointJacobian();
+	}
+	ECPointJacobian result(terms.first().multiples.first().curve);
+
+	int length = 0;
+	for (int i = 0; i < terms.size(); i++)
+	{
+		length = qMax(length, terms[i].digits.size());
+	}
+
+	for (int position = length - 1; position >= 0; position--)
+	{
+		if (!result.isInfinity())
+		{
+			result = result.doubled();
+		}
+		for (int i = 0; i < terms.size(); i++)
+		{
+			if (position >= terms[i].digits.size())
+			{
+				continue;
+			}
+			int digit = terms[i].digits[position];
+			if (digit > 0)
+			{
+				result += terms[i].multiples[digit / 2];
+			}
+			else if (digit < 0)
+			{
+				result += terms[i].multiples[-digit / 2].negated();
+			}
+		}
+	}
+	return result;
+}
+
+/// P, 3P, 5P, ..., (2^(w-1) - 1)P in affine form.
+QVector<ECPoint> ECMultiScalar::oddMultiples(const ECPoint &point, unsigned int width)
+{
+	QVector<ECPointJacobian> result;
+	result.reserve(1 << (width - 2));
+	result.append(ECPointJacobian(point));
+	ECPointJacobian doubledPoint = result.first().doubled();
+	for (int i = 1; i < (1 << (width - 2)); i++)
+	{
+		result.append(result.last() + doubledPoint);
+	}
+	return ECPointJacobian::toAffine(result);
+}
@@ -0,0 +1,78 @@
+#include "ecpublickey.h"
+
+#include "ecmultiscalar.h"
+
+#include "function.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+typedef QCache<QByteArray, QSharedPointer<const ECPublicKey> > ECPublicKeyCache;
+
+static QMutex cacheMutex;
+
+static ECPublicKeyCache &publicKeyCache()
+{
+	static ECPublicKeyCache cache(4096);
+	return cache;
+}
+
+ECPublicKey::ECPublicKey(const big_int &compressed, const EllipticCurvePtr &curve)
+	: curve(curve)
+{
+	valid = ECPoint::decompressionCoordinate(compressed, curve.data(), keyPoint);
+	if (valid)
+	{
+		odd = ECMultiScalar::oddMultiples(keyPoint, oddWidth);
+	}
+}
+
+bool ECPublicKey::isValid() const
+{
+	return valid;
+}
+
+const ECPoint &ECPublicKey::point() const
+{
+	return keyPoint;
+}
+
+const QVector<ECPoint> &ECPublicKey::oddMultiples() const
+{
+	return odd;
+}
+
+unsigned int ECPublicKey::oddMultiplesWidth()
+{
+	return oddWidth;
+}
+
+/// A missing key is decompressed outside of the lock, so other threads don't wait for it.
+QSharedPointer<const ECPublicKey> ECPublicKey::forKey(const big_int &compressed, const EllipticCurvePtr &curve)
+{
+	QByteArray key = curve->key();
+	key.append(Function::big_intToByteArray(compressed).toHex());
+
+	{
+		QMutexLocker locker(&cacheMutex);
+		QSharedPointer<const ECPublicKey> *cached = publicKeyCache().object(key);
+		if (cached)
+		{
+			return *cached;
+		}
+	}
+
+	QSharedPointer<const ECPublicKey> result(new ECPublicKey(compressed, curve));
+
+	QMutexLocker locker(&cacheMutex);
+	publicKeyCache().insert(key, new QSharedPointer<const ECPublicKey>(result));
+	return result;
+}
+
+/// Sets the number of keys kept by forKey(), 0 disables the cache.
+void ECPublicKey::setCacheCapacity(int capacity)
+{
+	QMutexLocker locker(&cacheMutex);
+	publicKeyCache().setMaxCost(capacity);
+}
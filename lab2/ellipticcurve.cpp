@@ -0,0 +1,93 @@
+#include "ellipticcurve.h"
+
+#include "function.h"
+
+EllipticCurve::EllipticCurve(const big_int &p, const big_int &a, const big_int &b)
+	: primeField(p), minusThree(false), n(0), h(1)
+{
+	initialize(a, b);
+}
+
+EllipticCurve::EllipticCurve(const big_int &p, const big_int &a, const big_int &b,
+							 const big_int &n, const big_int &h,
+							 const big_int &Gx, const big_int &Gy)
+	: primeField(p), minusThree(false), n(n), h(h)
+{
+	initialize(a, b);
+	gx = primeField.fromBigInt(Gx);
+	gy = primeField.fromBigInt(Gy);
+}
+
+void EllipticCurve::initialize(const big_int &a, const big_int &b)
+{
+	aElement = primeField.fromBigInt(a);
+	bElement = primeField.fromBigInt(b);
+	minusThree = primeField.isValid() && (aElement == primeField.fromBigInt(-3));
+
+	const big_int values[] = {getP(), getA(), getB()};
+	for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		curveKey.append(Function::big_intToByteArray(values[i]).toHex());
+		curveKey.append(':');
+	}
+}
+
+const PrimeField &EllipticCurve::field() const
+{
+	return primeField;
+}
+
+const FieldElement &EllipticCurve::a() const
+{
+	return aElement;
+}
+
+const FieldElement &EllipticCurve::b() const
+{
+	return bElement;
+}
+
+const FieldElement &EllipticCurve::generatorX() const
+{
+	return gx;
+}
+
+const FieldElement &EllipticCurve::generatorY() const
+{
+	return gy;
+}
+
+bool EllipticCurve::aIsMinusThree() const
+{
+	return minusThree;
+}
+
+const big_int &EllipticCurve::getP() const
+{
+	return primeField.modulus();
+}
+
+big_int EllipticCurve::getA() const
+{
+	return primeField.toBigInt(aElement);
+}
+
+big_int EllipticCurve::getB() const
+{
+	return primeField.toBigInt(bElement);
+}
+
+const big_int &EllipticCurve::getN() const
+{
+	return n;
+}
+
+const big_int &EllipticCurve::getH() const
+{
+	return h;
+}
+
+const QByteArray &EllipticCurve::key() const
+{
+	return curveKey;
+}
@@ -1,124 +1,340 @@
 #include "ellipticcurvepoint.h"
 
+#include "ecmultiscalar.h"
+
 #include "function.h"
 
 ECPoint::ECPoint()
+	: curve(0)
+{
+
+}
+
+ECPoint::ECPoint(const EllipticCurve *curve, const big_int &x, const big_int &y)
+	: curve(curve)
 {
+	this->x = curve->field().fromBigInt(x);
+	this->y = curve->field().fromBigInt(y);
+}
 
+ECPoint ECPoint::generator(const EllipticCurve *curve)
+{
+	ECPoint result;
+	result.curve = curve;
+	result.x = curve->generatorX();
+	result.y = curve->generatorY();
+	return result;
+}
+
+big_int ECPoint::getA() const
+{
+	return curve->getA();
+}
+
+big_int ECPoint::getB() const
+{
+	return curve->getB();
 }
 
-ECPoint::ECPoint(const ECPoint &point)
+big_int ECPoint::getX() const
 {
-	a = point.a;
-	b = point.b;
-	x = point.x;
-	y = point.y;
-	field = point.field;
+	return curve->field().toBigInt(x);
 }
 
-ECPoint::ECPoint(const big_int &a, const big_int &b, const big_int &x, const big_int &y, const big_int &field)
-	: a(a), b(b), x(x), y(y), field(field)
+big_int ECPoint::getY() const
 {
+	return curve->field().toBigInt(y);
+}
+
+big_int ECPoint::getField() const
+{
+	return curve->getP();
 }
 
 big_int ECPoint::compressionCoordinate(const ECPoint &p)
 {
-	quint8 y = ((p.y).is_odd()) ? (0x03) : 0x02;
+	quint8 y = (p.getY().is_odd()) ? (0x03) : 0x02;
 	QByteArray tmp;
 	tmp.append(y);
-	tmp.append(Function::big_intToByteArray(p.x));
+	tmp.append(Function::big_intToByteArray(p.getX()));
 	return Function::big_intFromByteArray(tmp);
 }
 
-ECPoint ECPoint::decompressionCoordinate(const big_int &Gx, const big_int &a, const big_int &b, const big_int &field)
+bool ECPoint::decompressionCoordinate(const big_int &Gx, const EllipticCurve *curve, ECPoint &point)
 {
 	ECPoint result;
-	result.a = a;
-	result.b = b;
-	result.field = field;
+	result.curve = curve;
 
 	QByteArray xPoint = Function::big_intToByteArray(Gx);
 	quint8 y = xPoint.at(0);
 	xPoint = xPoint.remove(0, 1);
-	result.x = Function::big_intFromByteArray(xPoint);
 
-	big_int tmp = (Arageli::pow(result.x , 3) + (a * result.x) + b) % field;
-	big_int beta = Function::modSqrt(tmp, field);
-	result.y = ((beta % 2) == (y % 2)) ? beta : field - beta;
+	const PrimeField &F = curve->field();
+	result.x = F.fromBigInt(Function::big_intFromByteArray(xPoint));
 
-	return result;
+	const big_int &field = F.modulus();
+	FieldElement tmp = F.add(F.mul(F.add(F.sqr(result.x), curve->a()), result.x), curve->b());
+	big_int beta;
+	if (!Function::modSqrt(F.toBigInt(tmp), field, beta))
+	{
+		return false;
+	}
+	result.y = F.fromBigInt(((beta % 2) == (y % 2)) ? beta : field - beta);
+
+	point = result;
+	return true;
 }
 
 const ECPoint operator+(const ECPoint &left, const ECPoint &right)
+{
+	return (ECPointJacobian(left) + right).toAffine();
+}
+
+ECPoint &operator+=(ECPoint &left, const ECPoint &right)
+{
+	left = left + right;
+	return left;
+}
+
+const ECPoint operator*(const big_int &x, const ECPoint &p)
+{
+	return ECPointJacobian::multiply(x, p).toAffine();
+}
+
+bool operator==(const ECPoint &left, const ECPoint &right)
+{
+	return (left.x == right.x) && (left.y == right.y);
+}
+
+ECPoint ECPoint::negated() const
+{
+	ECPoint result(*this);
+	result.y = curve->field().neg(y);
+	return result;
+}
+
+ECPointJacobian::ECPointJacobian()
+	: curve(0)
+{
+
+}
+
+ECPointJacobian::ECPointJacobian(const EllipticCurve *curve)
+	: curve(curve)
+{
+}
+
+ECPointJacobian::ECPointJacobian(const ECPoint &point)
+	: curve(point.curve), X(point.x), Y(point.y), Z(point.curve->field().one())
+{
+}
+
+bool ECPointJacobian::isInfinity() const
+{
+	return Z.isZero();
+}
+
+ECPoint ECPointJacobian::toAffine() const
 {
 	ECPoint result;
-	result.a = left.a;
-	result.b = left.b;
-	result.field = left.field;
+	result.curve = curve;
+
+	if (isInfinity())
+	{
+		return result;
+	}
 
-	big_int dy;
-	big_int dx;
+	const PrimeField &field = curve->field();
+	FieldElement zInverse = field.inv(Z);
+	FieldElement zInverse2 = field.sqr(zInverse);
+	result.x = field.mul(X, zInverse2);
+	result.y = field.mul(Y, field.mul(zInverse2, zInverse));
+	return result;
+}
 
-	if (left == right)
+/// Converts all points to affine form with a single inversion.
+/** Montgomery's trick: inverting Z1 * ... * Zn and 3 (n - 1) multiplications
+	give every 1 / Zi. Points at infinity are skipped and come out as (0, 0). */
+QVector<ECPoint> ECPointJacobian::toAffine(const QVector<ECPointJacobian> &points)
+{
+	QVector<ECPoint> result(points.size());
+	if (points.isEmpty())
 	{
-		dy = 3 * left.x * left.x + left.a;
-		dx = 2 * left.y;
+		return result;
 	}
-	else
+
+	const PrimeField &F = points.first().curve->field();
+	QVector<FieldElement> products(points.size());
+	FieldElement product = F.one();
+	for (int i = 0; i < points.size(); i++)
 	{
-		dy = right.y - left.y;
-		dx = right.x - left.x;
+		if (!points[i].isInfinity())
+		{
+			product = F.mul(product, points[i].Z);
+		}
+		products[i] = product;
 	}
 
-	dx += (dx < 0) ? left.field : big_int(0);
-	dy += (dy < 0) ? left.field : big_int(0);
+	FieldElement inverse = F.inv(product);
+	for (int i = points.size() - 1; i >= 0; i--)
+	{
+		result[i].curve = points[i].curve;
+		if (points[i].isInfinity())
+		{
+			continue;
+		}
+		FieldElement zInverse = (i > 0) ? F.mul(inverse, products[i - 1]) : inverse;
+		inverse = F.mul(inverse, points[i].Z);
 
-	big_int m = (dy * inverse_mod(dx, left.field)) % left.field;
-	m += (m < 0) ? left.field : big_int(0);
+		FieldElement zInverse2 = F.sqr(zInverse);
+		result[i].x = F.mul(points[i].X, zInverse2);
+		result[i].y = F.mul(points[i].Y, F.mul(zInverse2, zInverse));
+	}
+	return result;
+}
+
+ECPointJacobian ECPointJacobian::doubled() const
+{
+	ECPointJacobian result(curve);
 
-	if (left == right)
+	if (isInfinity() || Y.isZero())
 	{
-		result.x = (m * m - left.x - left.x) % left.field;
-		result.y = (m * (left.x - result.x) - left.y) % left.field;
+		return result;
+	}
+
+	const PrimeField &F = curve->field();
+	FieldElement YY = F.sqr(Y);
+	FieldElement ZZ = F.sqr(Z);
+	FieldElement S = F.mul(X, YY);
+	S = F.add(S, S);
+	S = F.add(S, S);
+	FieldElement M;
+	if (curve->aIsMinusThree())
+	{
+		M = F.mul(F.sub(X, ZZ), F.add(X, ZZ));
+		M = F.add(F.add(M, M), M);
 	}
 	else
 	{
-		result.x = (m * m - left.x - right.x) % left.field;
-		result.y = (m * (left.x - result.x) - left.y) % left.field;
+		FieldElement XX = F.sqr(X);
+		M = F.add(F.add(XX, XX), XX);
+		M = F.add(M, F.mul(curve->a(), F.sqr(ZZ)));
 	}
+	FieldElement YYYY = F.sqr(YY);
+	YYYY = F.add(YYYY, YYYY);
+	YYYY = F.add(YYYY, YYYY);
+	YYYY = F.add(YYYY, YYYY);
 
-	result.x += (result.x < 0) ? left.field : big_int(0);
-	result.y += (result.y < 0) ? left.field : big_int(0);
+	result.X = F.sub(F.sqr(M), F.add(S, S));
+	result.Y = F.sub(F.mul(M, F.sub(S, result.X)), YYYY);
+	FieldElement YZ = F.mul(Y, Z);
+	result.Z = F.add(YZ, YZ);
+	return result;
+}
 
+ECPointJacobian ECPointJacobian::negated() const
+{
+	ECPointJacobian result(*this);
+	result.Y = curve->field().neg(Y);
 	return result;
 }
 
-ECPoint &operator+=(ECPoint &left, const ECPoint &right)
+const ECPointJacobian operator+(const ECPointJacobian &left, const ECPointJacobian &right)
 {
-	left = left + right;
-	return left;
+	if (left.isInfinity())
+	{
+		return right;
+	}
+	if (right.isInfinity())
+	{
+		return left;
+	}
+
+	const PrimeField &F = left.curve->field();
+
+	FieldElement Z1Z1 = F.sqr(left.Z);
+	FieldElement Z2Z2 = F.sqr(right.Z);
+	FieldElement U1 = F.mul(left.X, Z2Z2);
+	FieldElement U2 = F.mul(right.X, Z1Z1);
+	FieldElement S1 = F.mul(left.Y, F.mul(right.Z, Z2Z2));
+	FieldElement S2 = F.mul(right.Y, F.mul(left.Z, Z1Z1));
+
+	FieldElement H = F.sub(U2, U1);
+	FieldElement r = F.sub(S2, S1);
+
+	ECPointJacobian result(left.curve);
+
+	if (H.isZero())
+	{
+		if (r.isZero())
+		{
+			return left.doubled();
+		}
+		return result;
+	}
+
+	FieldElement HH = F.sqr(H);
+	FieldElement HHH = F.mul(H, HH);
+	FieldElement V = F.mul(U1, HH);
+
+	result.X = F.sub(F.sub(F.sqr(r), HHH), F.add(V, V));
+	result.Y = F.sub(F.mul(r, F.sub(V, result.X)), F.mul(S1, HHH));
+	result.Z = F.mul(F.mul(left.Z, right.Z), H);
+	return result;
 }
 
-const ECPoint operator*(big_int x, ECPoint p)
+const ECPointJacobian operator+(const ECPointJacobian &left, const ECPoint &right)
 {
-	ECPoint result(p);
-	x = x - 1;
-	while (!x.is_null())
+	if (left.isInfinity())
 	{
+		return ECPointJacobian(right);
+	}
+
+	const PrimeField &F = left.curve->field();
+
+	FieldElement Z1Z1 = F.sqr(left.Z);
+	FieldElement U2 = F.mul(right.x, Z1Z1);
+	FieldElement S2 = F.mul(right.y, F.mul(left.Z, Z1Z1));
+
+	FieldElement H = F.sub(U2, left.X);
+	FieldElement r = F.sub(S2, left.Y);
 
-		if (!((x % 2).is_null()))
+	ECPointJacobian result(left.curve);
+
+	if (H.isZero())
+	{
+		if (r.isZero())
 		{
-			result += p;
-			x = x - 1;
+			return left.doubled();
 		}
-		x = x / 2;
-		p += p;
+		return result;
 	}
+
+	FieldElement HH = F.sqr(H);
+	FieldElement HHH = F.mul(H, HH);
+	FieldElement V = F.mul(left.X, HH);
+
+	result.X = F.sub(F.sub(F.sqr(r), HHH), F.add(V, V));
+	result.Y = F.sub(F.mul(r, F.sub(V, result.X)), F.mul(left.Y, HHH));
+	result.Z = F.mul(left.Z, H);
 	return result;
 }
 
-bool operator==(const ECPoint &left, const ECPoint &right)
+ECPointJacobian &operator+=(ECPointJacobian &left, const ECPointJacobian &right)
+{
+	left = left + right;
+	return left;
+}
+
+ECPointJacobian &operator+=(ECPointJacobian &left, const ECPoint &right)
 {
-	return (left.x == right.x) || (left.y == right.y);
+	left = left + right;
+	return left;
 }
 
+ECPointJacobian ECPointJacobian::multiply(const big_int &x, const ECPoint &p)
+{
+	ECMultiScalar result;
+	result.add(x, p);
+	return result.calculate();
+}
@@ -0,0 +1,81 @@
+#include "fixedbasepowertable.h"
+
+#include "function.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+FixedBasePowerTable::FixedBasePowerTable(const big_int &base, const big_int &modulus, unsigned int exponentLength)
+	: base(base), modulus(modulus),
+	  windowCount((exponentLength + windowWidth - 1) / windowWidth)
+{
+	big_int windowBase = mod(base, modulus);
+	for (unsigned int i = 0; i < windowCount; i++)
+	{
+		QVector<big_int> powers;
+		powers.reserve((1 << windowWidth) - 1);
+		powers.append(windowBase);
+		for (unsigned int j = 1; j < (1 << windowWidth) - 1; j++)
+		{
+			powers.append(powers.last() * windowBase % modulus);
+		}
+		windowBase = powers.last() * windowBase % modulus;
+		windows.append(powers);
+	}
+}
+
+big_int FixedBasePowerTable::power(const big_int &x) const
+{
+	if (x.length() > windowCount * windowWidth)
+	{
+		return power_mod(base, x, modulus);
+	}
+
+	big_int result = 1;
+	for (unsigned int i = 0; i < windowCount; i++)
+	{
+		unsigned int digit = Function::bits(x, i * windowWidth, windowWidth);
+		if (digit)
+		{
+			result = result * windows[i][digit - 1] % modulus;
+		}
+	}
+	return mod(result, modulus);
+}
+
+/// Shares a table between all domains with the same base while any of them is alive.
+QSharedPointer<const FixedBasePowerTable> FixedBasePowerTable::forBase(const big_int &base, const big_int &modulus,
+																	   unsigned int exponentLength)
+{
+	static QMutex mutex;
+	static QMap<QByteArray, QWeakPointer<const FixedBasePowerTable> > tables;
+
+	QByteArray key = Function::big_intToByteArray(modulus).toHex();
+	key.append(':');
+	key.append(Function::big_intToByteArray(base).toHex());
+	key.append(':');
+	key.append(QByteArray::number(exponentLength));
+
+	QMutexLocker locker(&mutex);
+	QSharedPointer<const FixedBasePowerTable> table = tables.value(key).toStrongRef();
+	if (table.isNull())
+	{
+		QMap<QByteArray, QWeakPointer<const FixedBasePowerTable> >::iterator i = tables.begin();
+		while (i != tables.end())
+		{
+			if (i.value().isNull())
+			{
+				i = tables.erase(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		table = QSharedPointer<const FixedBasePowerTable>(new FixedBasePowerTable(base, modulus, exponentLength));
+		tables.insert(key, table);
+	}
+	return table;
+}
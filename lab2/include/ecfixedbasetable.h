@@ -0,0 +1,42 @@
+#ifndef ECFIXEDBASETABLE_H
+#define ECFIXEDBASETABLE_H
+
+#include <ellipticcurvepoint.h>
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QVector>
+
+/// Precomputed multiples of a fixed point for scalar multiplication without doublings.
+/** Window i holds j * 2^(w * i) * P for j = 1 .. 2^w - 1, so x * P is a sum
+	of one table point per w-bit window of x. A wider table of odd multiples
+	is kept for the interleaved wNAF of ECMultiScalar. All table points are
+	affine, so every addition is a mixed one. */
+class ECFixedBaseTable
+{
+public:
+	ECFixedBaseTable(const EllipticCurvePtr &curve, const ECPoint &point, unsigned int scalarLength);
+
+	ECPointJacobian multiply(const big_int &x) const;
+
+	const ECPoint &point() const;
+	const QVector<ECPoint> &oddMultiples() const;
+	static unsigned int oddMultiplesWidth();
+
+	static QSharedPointer<const ECFixedBaseTable> forPoint(const EllipticCurvePtr &curve, const ECPoint &point,
+														  unsigned int scalarLength);
+
+private:
+	static QByteArray pointKey(const ECPoint &point);
+
+	EllipticCurvePtr curve;
+	ECPoint basePoint;
+	unsigned int windowCount;
+	QVector<QVector<ECPoint> > windows;
+	QVector<ECPoint> odd;
+
+	static const unsigned int windowWidth = 4;
+	static const unsigned int oddWidth = 7;
+};
+
+#endif // ECFIXEDBASETABLE_H
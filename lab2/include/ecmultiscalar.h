@@ -0,0 +1,40 @@
+#ifndef ECMULTISCALAR_H
+#define ECMULTISCALAR_H
+
+#include <ellipticcurvepoint.h>
+
+#include <QList>
+#include <QVector>
+
+class ECFixedBaseTable;
+class ECPublicKey;
+
+/// Simultaneous multiplication x1 * P1 + ... + xn * Pn (interleaved wNAF).
+/** All terms share one doubling chain; every non-zero wNAF digit
+	adds (or subtracts) one precomputed odd multiple of its point. */
+class ECMultiScalar
+{
+public:
+	ECMultiScalar();
+
+	void add(const big_int &x, const ECPoint &point);
+	void add(const big_int &x, const ECFixedBaseTable &table);
+	void add(const big_int &x, const ECPublicKey &key);
+
+	ECPointJacobian calculate() const;
+
+	static QVector<ECPoint> oddMultiples(const ECPoint &point, unsigned int width);
+
+private:
+	struct Term
+	{
+		QVector<int> digits;
+		QVector<ECPoint> multiples;
+	};
+
+	QList<Term> terms;
+
+	static const unsigned int windowWidth = 5;
+};
+
+#endif // ECMULTISCALAR_H
@@ -0,0 +1,38 @@
+#ifndef ECPUBLICKEY_H
+#define ECPUBLICKEY_H
+
+#include <ellipticcurvepoint.h>
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QVector>
+
+/// Decompressed public key together with its odd multiples for ECMultiScalar.
+/** Verification with a known key skips both the square root of the
+	decompression and the construction of the multiples: forKey() keeps the
+	most recently used keys in a bounded cache shared by all threads. */
+class ECPublicKey
+{
+public:
+	ECPublicKey(const big_int &compressed, const EllipticCurvePtr &curve);
+
+	/// The compressed key decodes to a point of the curve.
+	bool isValid() const;
+
+	const ECPoint &point() const;
+	const QVector<ECPoint> &oddMultiples() const;
+	static unsigned int oddMultiplesWidth();
+
+	static QSharedPointer<const ECPublicKey> forKey(const big_int &compressed, const EllipticCurvePtr &curve);
+	static void setCacheCapacity(int capacity);
+
+private:
+	EllipticCurvePtr curve;
+	ECPoint keyPoint;
+	QVector<ECPoint> odd;
+	bool valid;
+
+	static const unsigned int oddWidth = 6;
+};
+
+#endif // ECPUBLICKEY_H
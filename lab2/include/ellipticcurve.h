@@ -0,0 +1,62 @@
+#ifndef ELLIPTICCURVE_H
+#define ELLIPTICCURVE_H
+
+#include <big_int.hpp>
+
+#include <primefield.h>
+
+#include <QByteArray>
+#include <QSharedPointer>
+
+using namespace Arageli;
+
+/// Curve y^2 = x^3 + a x + b over F_p with the base point G of order n.
+/** The curve is immutable and shared by all of its points, so a point
+	carries only its coordinates and a plain pointer to the curve. The curve
+	is owned through EllipticCurvePtr by the signature domain, the fixed-base
+	tables and the cached public keys, which outlive the points they make.
+	Constants that depend only on the curve (the field backend, the a = -3
+	flag) are computed once here. */
+class EllipticCurve
+{
+public:
+	EllipticCurve(const big_int &p, const big_int &a, const big_int &b);
+	EllipticCurve(const big_int &p, const big_int &a, const big_int &b,
+				  const big_int &n, const big_int &h,
+				  const big_int &Gx, const big_int &Gy);
+
+	const PrimeField &field() const;
+	const FieldElement &a() const;
+	const FieldElement &b() const;
+	const FieldElement &generatorX() const;
+	const FieldElement &generatorY() const;
+
+	/// a = -3 (mod p) allows the cheaper doubling 3 (X - Z^2) (X + Z^2).
+	bool aIsMinusThree() const;
+
+	const big_int &getP() const;
+	big_int getA() const;
+	big_int getB() const;
+	const big_int &getN() const;
+	const big_int &getH() const;
+
+	/// Text form of p, a and b, used as a key by caches of curve data.
+	const QByteArray &key() const;
+
+private:
+	void initialize(const big_int &a, const big_int &b);
+
+	PrimeField primeField;
+	FieldElement aElement;
+	FieldElement bElement;
+	FieldElement gx;
+	FieldElement gy;
+	bool minusThree;
+	big_int n;
+	big_int h;
+	QByteArray curveKey;
+};
+
+typedef QSharedPointer<const EllipticCurve> EllipticCurvePtr;
+
+#endif // ELLIPTICCURVE_H
@@ -3,30 +3,73 @@
 
 #include <big_int.hpp>
 
+#include <ellipticcurve.h>
+
+#include <QVector>
+
 using namespace Arageli;
 
 class ECPoint
 {
 public:
 	ECPoint();
-	ECPoint(const ECPoint &point);
-	ECPoint(const big_int &a, const big_int &b, const big_int &x, const big_int &y, const big_int &field);
+	ECPoint(const EllipticCurve *curve, const big_int &x, const big_int &y);
+
+	static ECPoint generator(const EllipticCurve *curve);
 
 	friend const ECPoint operator+(const ECPoint &left, const ECPoint &right);
 	friend ECPoint& operator+=(ECPoint &left, const ECPoint &right);
 
-	friend const ECPoint operator*(big_int x, ECPoint p);
+	friend const ECPoint operator*(const big_int &x, const ECPoint &p);
 
 	friend bool operator==(const ECPoint& left, const ECPoint& right);
 
+	ECPoint negated() const;
+
 	static big_int compressionCoordinate(const ECPoint &p);
-	static ECPoint decompressionCoordinate(const big_int &Gx, const big_int &a, const big_int &b, const big_int &field);
+	/// False if Gx doesn't encode a point of the curve.
+	static bool decompressionCoordinate(const big_int &Gx, const EllipticCurve *curve, ECPoint &point);
+
+	big_int getA() const;
+	big_int getB() const;
+	big_int getX() const;
+	big_int getY() const;
+	big_int getField() const;
+
+	const EllipticCurve *curve;
+	FieldElement x;
+	FieldElement y;
+};
+
+/// Point in Jacobian coordinates (x = X / Z^2, y = Y / Z^3).
+/** Addition and doubling don't need modular inversion,
+	so the only inversion is made in toAffine(). Z = 0 is the point at infinity,
+	ECPointJacobian(curve) creates it. */
+class ECPointJacobian
+{
+public:
+	ECPointJacobian();
+	explicit ECPointJacobian(const EllipticCurve *curve);
+	explicit ECPointJacobian(const ECPoint &point);
+
+	bool isInfinity() const;
+	ECPoint toAffine() const;
+	static QVector<ECPoint> toAffine(const QVector<ECPointJacobian> &points);
+
+	ECPointJacobian doubled() const;
+	ECPointJacobian negated() const;
+
+	friend const ECPointJacobian operator+(const ECPointJacobian &left, const ECPointJacobian &right);
+	friend const ECPointJacobian operator+(const ECPointJacobian &left, const ECPoint &right);
+	friend ECPointJacobian& operator+=(ECPointJacobian &left, const ECPointJacobian &right);
+	friend ECPointJacobian& operator+=(ECPointJacobian &left, const ECPoint &right);
+
+	static ECPointJacobian multiply(const big_int &x, const ECPoint &p);
 
-	big_int a;
-	big_int b;
-	big_int x;
-	big_int y;
-	big_int field;
+	const EllipticCurve *curve;
+	FieldElement X;
+	FieldElement Y;
+	FieldElement Z;
 };
 
 #endif // ELLIPTICCURVEPOINT_H
@@ -0,0 +1,34 @@
+#ifndef FIXEDBASEPOWERTABLE_H
+#define FIXEDBASEPOWERTABLE_H
+
+#include <big_int.hpp>
+
+using namespace Arageli;
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QVector>
+
+/// Precomputed powers of a fixed base modulo p for exponentiation without squarings.
+/** Window i holds base^(j * 2^(w * i)) mod p for j = 1 .. 2^w - 1, so base^x
+	is a product of one table value per w-bit window of x. */
+class FixedBasePowerTable
+{
+public:
+	FixedBasePowerTable(const big_int &base, const big_int &modulus, unsigned int exponentLength);
+
+	big_int power(const big_int &x) const;
+
+	static QSharedPointer<const FixedBasePowerTable> forBase(const big_int &base, const big_int &modulus,
+															unsigned int exponentLength);
+
+private:
+	big_int base;
+	big_int modulus;
+	unsigned int windowCount;
+	QVector<QVector<big_int> > windows;
+
+	static const unsigned int windowWidth = 4;
+};
+
+#endif // FIXEDBASEPOWERTABLE_H
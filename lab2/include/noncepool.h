@@ -0,0 +1,52 @@
+#ifndef NONCEPOOL_H
+#define NONCEPOOL_H
+
+#include <big_int.hpp>
+
+using namespace Arageli;
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QWaitCondition>
+
+class CryptoGeneratorInterface;
+
+/// Background supply of precomputed (k, r) pairs for signing.
+/** k and r = (k G).x mod n (2012) or (alpha^k mod p) mod q (1994) don't
+	depend on the message, so a thread computes them ahead of time and the
+	signature only has to find s. The pool holds at most capacity pairs; every
+	pair is given out once. */
+class NoncePool
+{
+public:
+	NoncePool(int year, CryptoGeneratorInterface *parameters, int capacity = 256);
+	~NoncePool();
+
+	/// Takes a ready pair, returns false at once when the pool is empty.
+	bool take(QPair<big_int, big_int> &nonce);
+	int size();
+
+	/// The pairs can be used by a signature of this year and SignatureInterface::domainKey().
+	bool isMadeFor(int year, const QByteArray &domainKey) const;
+
+private:
+	class Filler;
+
+	bool waitForSpace();
+	void put(const QPair<big_int, big_int> &nonce);
+
+	int year;
+	QByteArray domainKey;
+
+	Filler *filler;
+	QList<QPair<big_int, big_int> > nonces;
+	int capacity;
+
+	QMutex mutex;
+	QWaitCondition notFull;
+	bool stopping;
+};
+
+#endif // NONCEPOOL_H
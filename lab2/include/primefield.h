@@ -0,0 +1,89 @@
+#ifndef PRIMEFIELD_H
+#define PRIMEFIELD_H
+
+#include <big_int.hpp>
+
+#include <QtGlobal>
+
+using namespace Arageli;
+
+/// Element of a prime field stored as fixed-width little-endian 64-bit limbs.
+/** Lives on the stack and is copied by value; only the first
+	PrimeField::limbCount() limbs are used, the rest stay zero. */
+class FieldElement
+{
+public:
+	FieldElement();
+
+	bool isZero() const;
+
+	friend bool operator==(const FieldElement &left, const FieldElement &right);
+	friend bool operator!=(const FieldElement &left, const FieldElement &right);
+
+	static const int MaxLimbs = 9;
+
+	quint64 limbs[MaxLimbs];
+};
+
+/// Arithmetic modulo an odd prime p of at most 64 * FieldElement::MaxLimbs bits.
+/** All operands and results are reduced to [0, p). The field lives in its
+	curve and points only refer to it, the arithmetic itself uses no heap data.
+	Reduction is chosen from the form of p: primes 2^k - c with a small c
+	(2^521 - 1, 2^256 - 617, 2^512 - 569, ...) are folded with shifts and
+	one short multiplication, other primes use Montgomery multiplication.
+	In the Montgomery case elements are kept as value * 2^(64 n) mod p, so
+	they must only be created and read through fromBigInt() and toBigInt(). */
+class PrimeField
+{
+public:
+	PrimeField();
+	explicit PrimeField(const big_int &p);
+
+	enum Reduction {
+		Montgomery,
+		Mersenne,
+		PseudoMersenne
+	};
+
+	bool isValid() const;
+	Reduction reduction() const;
+	int limbCount() const;
+	const big_int &modulus() const;
+
+	FieldElement fromBigInt(const big_int &value) const;
+	big_int toBigInt(const FieldElement &value) const;
+
+	FieldElement zero() const;
+	FieldElement one() const;
+
+	FieldElement add(const FieldElement &left, const FieldElement &right) const;
+	FieldElement sub(const FieldElement &left, const FieldElement &right) const;
+	FieldElement neg(const FieldElement &value) const;
+	FieldElement mul(const FieldElement &left, const FieldElement &right) const;
+	FieldElement sqr(const FieldElement &value) const;
+	FieldElement inv(const FieldElement &value) const;
+
+private:
+	void mulMontgomery(const quint64 *left, const quint64 *right, quint64 *result) const;
+	void reduceSpecialForm(const quint64 *wide, FieldElement &result) const;
+	void foldSpecialForm(const quint64 *value, int count, quint64 *result) const;
+
+	static void limbsFromBigInt(const big_int &value, quint64 *limbs, int count);
+	static big_int limbsToBigInt(const quint64 *limbs, int count);
+
+	int n;
+	Reduction reductionType;
+	/// p = 2^bits - c for the special-form reductions.
+	int bits;
+	quint64 c;
+	quint64 p[FieldElement::MaxLimbs];
+	/// p as big_int for conversions, 0 for an invalid field.
+	big_int modulusValue;
+	/// Montgomery constants: -p^(-1) mod 2^64 and 2^(64 n k) mod p for k = 1, 2, 3.
+	quint64 pInverse;
+	FieldElement montgomeryOne;
+	FieldElement montgomerySquare;
+	FieldElement montgomeryCube;
+};
+
+#endif // PRIMEFIELD_H
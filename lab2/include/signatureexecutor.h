@@ -0,0 +1,73 @@
+#ifndef SIGNATUREEXECUTOR_H
+#define SIGNATUREEXECUTOR_H
+
+#include <big_int.hpp>
+
+using namespace Arageli;
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+class CryptoGeneratorInterface;
+
+/// One signing or verification job of SignatureExecutor.
+struct SignatureTask
+{
+	enum Type
+	{
+		Sign,
+		Verify
+	};
+
+	SignatureTask();
+
+	Type type;
+	QByteArray message;
+	/// Secret key for Sign, public key for Verify.
+	big_int key;
+	/// Result of Sign, input of Verify.
+	QByteArray signature;
+	/// The signature is made (Sign) or is correct (Verify).
+	bool result;
+};
+
+/// Signs and verifies messages on a pool of threads.
+/** Every worker owns a SignatureInterface made by SignatureFactory with its
+	own copy of the domain parameters, so the stateful signature objects are
+	never shared. Each worker takes tasks from the back of its own queue and,
+	when it runs dry, steals from the front of the other queues. */
+class SignatureExecutor
+{
+public:
+	SignatureExecutor(int year, CryptoGeneratorInterface *parameters,
+					  int threadCount = QThread::idealThreadCount());
+	~SignatureExecutor();
+
+	int threadCount() const;
+
+	/// Runs all tasks and returns when they are done.
+	void run(QVector<SignatureTask> &tasks);
+
+private:
+	class Worker;
+
+	bool takeTask(int worker, int &task);
+	bool waitForBatch(int &generation);
+	void taskDone();
+
+	QList<Worker *> workers;
+	SignatureTask *batch;
+
+	QMutex mutex;
+	QWaitCondition batchStarted;
+	QWaitCondition batchFinished;
+	int batchGeneration;
+	int remainingTasks;
+	bool stopping;
+};
+
+#endif // SIGNATUREEXECUTOR_H
@@ -1,12 +1,15 @@
 #ifndef SIGNATUREFACTORY_H
 #define SIGNATUREFACTORY_H
 
+class CryptoGeneratorInterface;
 class SignatureInterface;
 
 class SignatureFactory
 {
 public:
 	static SignatureInterface *signatureByYear(int year);
+	/// Signature with its own copy of the parameters, safe to use from another thread.
+	static SignatureInterface *signatureWithParameters(int year, CryptoGeneratorInterface *parameters);
 };
 
 #endif // SIGNATUREFACTORY_H
@@ -3,17 +3,44 @@
 
 #include <signatureinterface.h>
 
+#include <fixedbasepowertable.h>
+
 #include <QPair>
+#include <QSharedPointer>
 
 class SignatureGost_1994 : public SignatureInterface
 {
 public:
 	SignatureGost_1994();
 
+	/// Domain parameters taken from the generator once, not on every operation.
+	struct Domain
+	{
+		/// p and q are greater than 1, so the alpha table is built.
+		bool isValid() const;
+
+		big_int p;
+		big_int q;
+		big_int alpha;
+		QSharedPointer<const FixedBasePowerTable> alphaTable;
+		/// p, q and alpha in text form.
+		QByteArray key;
+	};
+
+	const Domain &domain();
+
+	static QByteArray sign(const Domain &domain, const big_int &secretKey, const QByteArray &digest);
+	static bool verify(const Domain &domain, const big_int &publicKey, const QByteArray &digest,
+					   const QByteArray &sign);
+
 	virtual void setParameter(const QByteArray &key, const big_int &value);
 	virtual void setParameters(CryptoGeneratorInterface *parameters);
 
 	virtual void generateNewKeys();
+
+	virtual QByteArray signDigest(const QByteArray &digest);
+	virtual QByteArray domainKey();
+	virtual bool parametersAreSupported();
 protected:
 	virtual int gostYear();
 
@@ -24,6 +51,13 @@ protected:
 private:
 	void generateSecretKey();
 
+	static big_int calculateR(const Domain &domain, const big_int &k);
+	static big_int calculateU(const Domain &domain, const big_int &publicKey,
+							  const big_int &z1, const big_int &z2);
+
+	Domain resolvedDomain;
+	bool domainChanged;
+
 	virtual big_int calculateV();
 	virtual big_int calculateU(const big_int &z1, const big_int &z2);
 };
@@ -4,19 +4,56 @@
 #include <signatureinterface.h>
 
 #include <ellipticcurvepoint.h>
+#include <ecfixedbasetable.h>
+#include <ecpublickey.h>
 
 #include <QPair>
+#include <QSharedPointer>
+#include <QVector>
+
+/// One entry of SignatureGost_2012::verifyBatch().
+struct SignatureBatchItem
+{
+	/// Message hash as returned by HashFactory.
+	QByteArray hash;
+	QByteArray signature;
+	/// Compressed public key.
+	big_int publicKey;
+};
 
 class SignatureGost_2012 : public SignatureInterface
 {
 public:
 	SignatureGost_2012();
 
+	/// Curve and generator table resolved from the generator parameters.
+	struct Domain
+	{
+		/// The field backend supports p, so the table is built.
+		bool isValid() const;
+
+		EllipticCurvePtr curve;
+		QSharedPointer<const ECFixedBaseTable> generatorTable;
+		/// p, a, b, n, Gx and Gy in text form.
+		QByteArray key;
+	};
+
+	const Domain &domain();
+
+	static QByteArray sign(const Domain &domain, const big_int &secretKey, const QByteArray &digest);
+	static bool verify(const Domain &domain, const big_int &publicKey, const QByteArray &digest,
+					   const QByteArray &sign);
+
+	QVector<bool> verifyBatch(const QVector<SignatureBatchItem> &items);
 
 	void setParameter(const QByteArray &key, const big_int &value);
 	virtual void setParameters(CryptoGeneratorInterface *parameters);
 
 	virtual void generateNewKeys();
+
+	virtual QByteArray signDigest(const QByteArray &digest);
+	virtual bool parametersAreSupported();
+	virtual QByteArray domainKey();
 protected:
 	virtual int gostYear();
 
@@ -27,9 +64,12 @@ protected:
 private:
 	void generateSecretKey();
 
-	QPair<big_int, big_int> calculateSignParts();
+	static big_int calculateR(const Domain &domain, const big_int &k);
+	static ECPointJacobian calculateC(const Domain &domain, const big_int &publicKey,
+									  const big_int &z1, const big_int &z2);
 
-	ECPoint G;
+	Domain resolvedDomain;
+	bool domainChanged;
 
 	virtual big_int calculateV();
 	virtual big_int calculateU(const big_int &z1, const big_int &z2);
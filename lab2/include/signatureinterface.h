@@ -8,8 +8,10 @@ using namespace Arageli;
 #include <QByteArray>
 #include <QPair>
 
+class QBuffer;
 class QIODevice;
 class CryptoGeneratorInterface;
+class NoncePool;
 
 
 class SignatureInterface
@@ -25,6 +27,10 @@ public:
 	virtual void setParameter(const QByteArray &key, const big_int &value);
 	virtual void setParameters(CryptoGeneratorInterface *parameters);
 
+	/// Order of the subgroup: n for 2012, q for 1994.
+	big_int getModul();
+	/// Text form of all domain parameters, two signatures share nonces only if their keys are equal.
+	virtual QByteArray domainKey() = 0;
 	big_int getSecretKey();
 	big_int getPublicKey();
 
@@ -37,15 +43,29 @@ public:
 	bool calculateSign();
 	virtual bool verifySign();
 
+	/// Signs a digest made by HashFactory with the current parameters and secret key.
+	virtual QByteArray signDigest(const QByteArray &digest) = 0;
+
+	/// The arithmetic can work with the current parameters, signing and verification fail otherwise.
+	virtual bool parametersAreSupported();
+
 	void generateNewParameters();
 	virtual void generateNewKeys() = 0;
 
+	void setNoncePool(NoncePool *pool);
+	QPair<big_int, big_int> generateNonce();
+
 protected:
 	virtual int gostYear() = 0;
 	bool mayBeSigned();
 	bool mayBeVerified();
 	virtual bool secretKeyIsCorrect() = 0;
 
+	static int signPartLength(const big_int &modul);
+	static QByteArray joinSign(const big_int &r, const big_int &s, const big_int &modul);
+	static bool splitSign(const QByteArray &sign, const big_int &modul, big_int &r, big_int &s);
+	static big_int hashFromDigest(const QByteArray &digest, const big_int &modul);
+
 	QPair<big_int, big_int> calculateSignParts();
 	virtual big_int calculateK();
 	virtual big_int calculateR(const big_int &k) = 0;
@@ -61,11 +81,13 @@ protected:
 	bool openInputDevice();
 	void tryOpenInputDevice();
 	QIODevice *inputDevice;
+	QBuffer *messageBuffer;
 
 	void calculateHash();
 	big_int hash;
 
 	CryptoGeneratorInterface *cryptoGenerator;
+	NoncePool *noncePool;
 
 	big_int secretKey;
 	big_int publicKey;
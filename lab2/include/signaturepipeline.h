@@ -0,0 +1,73 @@
+#ifndef SIGNATUREPIPELINE_H
+#define SIGNATUREPIPELINE_H
+
+#include <big_int.hpp>
+
+using namespace Arageli;
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+class CryptoGeneratorInterface;
+class QIODevice;
+class SignatureInterface;
+
+/// One document of SignaturePipeline.
+struct SignatureJob
+{
+	SignatureJob(QIODevice *input = 0);
+
+	/// Opened for reading if it isn't open yet; not owned by the job.
+	QIODevice *input;
+	QByteArray signature;
+	/// The input was read and signed.
+	bool result;
+};
+
+/// Hashes documents on one pool of threads and signs the digests on another.
+/** Hash threads read the inputs and put their digests into a bounded queue,
+	sign threads take the digests from it. A hash thread waits while the queue
+	is full, so reading never runs far ahead of signing. Every sign thread owns
+	a signature object with its own copy of the parameters. */
+class SignaturePipeline
+{
+public:
+	SignaturePipeline(int year, CryptoGeneratorInterface *parameters, const big_int &secretKey,
+					  int hashThreadCount = 2, int signThreadCount = QThread::idealThreadCount(),
+					  int queueCapacity = 64);
+	~SignaturePipeline();
+
+	/// Signs all jobs and returns when they are done.
+	void run(QVector<SignatureJob> &jobs);
+
+private:
+	class HashWorker;
+	class SignWorker;
+
+	bool takeJob(int &job);
+	void putDigest(int job, const QByteArray &digest);
+	bool takeDigest(QPair<int, QByteArray> &digest);
+	void hashWorkerDone();
+
+	int year;
+	int hashThreadCount;
+	QList<SignatureInterface *> signatures;
+
+	SignatureJob *batch;
+	int batchSize;
+	int nextJob;
+	int runningHashWorkers;
+	QList<QPair<int, QByteArray> > digests;
+	int capacity;
+
+	QMutex mutex;
+	QWaitCondition notFull;
+	QWaitCondition notEmpty;
+};
+
+#endif // SIGNATUREPIPELINE_H
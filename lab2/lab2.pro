@@ -26,14 +26,32 @@ SOURCES += \
 	signatureinterface.cpp \
 	signaturegost_1994.cpp \
 	signaturegost_2012.cpp \
-	ellipticcurvepoint.cpp
+	primefield.cpp \
+	ellipticcurve.cpp \
+	ellipticcurvepoint.cpp \
+	ecfixedbasetable.cpp \
+	ecmultiscalar.cpp \
+	ecpublickey.cpp \
+	signatureexecutor.cpp \
+	noncepool.cpp \
+	signaturepipeline.cpp \
+	fixedbasepowertable.cpp
 
 HEADERS += \
 	include/signatureinterface.h \
 	include/signaturefactory.h \
 	include/signaturegost_1994.h \
 	include/signaturegost_2012.h \
-	include/ellipticcurvepoint.h
+	include/primefield.h \
+	include/ellipticcurve.h \
+	include/ellipticcurvepoint.h \
+	include/ecfixedbasetable.h \
+	include/ecmultiscalar.h \
+	include/ecpublickey.h \
+	include/signatureexecutor.h \
+	include/noncepool.h \
+	include/signaturepipeline.h \
+	include/fixedbasepowertable.h
 
 LIBS += -L$$PWD/../arageli/lib/ -larageli \
 	-L$$PWD/../extra/ -lextra \
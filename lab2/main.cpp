@@ -1,6 +1,7 @@
 #include <QCoreApplication>
 #include <QByteArray>
 #include <QDebug>
+#include <QThread>
 
 #include <iostream>
 #include <time.h>
@@ -8,17 +9,147 @@
 #include "signaturefactory.h"
 #include "signaturegost_1994.h"
 #include "function.h"
+#include "primefield.h"
+#include "ellipticcurvepoint.h"
+#include "ecfixedbasetable.h"
+#include "noncepool.h"
+
+#include "cryptogeneratorfactory.h"
+#include "cryptogeneratorinterface.h"
 
 #include "prime.hpp"
 
 using namespace std;
 
+/// Compares every field operation with big_int arithmetic on p - 1, 0 and random values.
+bool checkField(const big_int &p, PrimeField::Reduction reduction)
+{
+	PrimeField F(p);
+	if (!F.isValid() || F.reduction() != reduction)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < 200; i++)
+	{
+		big_int a = (i == 0) ? p - 1 : big_int::random_in_range(p);
+		big_int b = (i < 2) ? big_int(i) : big_int::random_in_range(p);
+		FieldElement x = F.fromBigInt(a);
+		FieldElement y = F.fromBigInt(b);
+
+		if (F.toBigInt(x) != a
+				|| F.toBigInt(F.add(x, y)) != mod(a + b, p)
+				|| F.toBigInt(F.sub(x, y)) != mod(a - b, p)
+				|| F.toBigInt(F.neg(y)) != mod(-b, p)
+				|| F.toBigInt(F.mul(x, y)) != mod(a * b, p)
+				|| F.toBigInt(F.sqr(x)) != mod(a * a, p)
+				|| (!x.isZero() && F.toBigInt(F.mul(x, F.inv(x))) != 1))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Checks that the digits of the width-w NAF add up to x.
+bool checkWnaf(const big_int &x, unsigned int width)
+{
+	QVector<int> digits = Function::wnaf(x, width);
+	big_int sum = 0;
+	for (int i = digits.size() - 1; i >= 0; i--)
+	{
+		sum = sum * 2 + digits[i];
+	}
+	return sum == x;
+}
+
+EllipticCurvePtr curveOf(SignatureInterface *signature)
+{
+	return EllipticCurvePtr(new EllipticCurve(signature->getParameter("p"), signature->getParameter("a"),
+											  signature->getParameter("b"), signature->getParameter("n"),
+											  signature->getParameter("h"), signature->getParameter("Gx"),
+											  signature->getParameter("Gy")));
+}
+
+/// Compares wNAF and fixed-base multiplication with plain double-and-add.
+bool checkMultiply(SignatureInterface *signature)
+{
+	EllipticCurvePtr curve = curveOf(signature);
+	ECPoint G = ECPoint::generator(curve.data());
+	ECFixedBaseTable table(curve, G, curve->getN().length());
+
+	for (int i = 0; i < 10; i++)
+	{
+		big_int k = big_int::random_in_range(curve->getN());
+		ECPointJacobian expected(curve.data());
+		for (int j = k.length() - 1; j >= 0; j--)
+		{
+			expected = expected.doubled();
+			if (k.bit(j))
+			{
+				expected += G;
+			}
+		}
+
+		if (!checkWnaf(k, 5)
+				|| !(k * G == expected.toAffine())
+				|| !(table.multiply(k).toAffine() == expected.toAffine()))
+		{
+			return false;
+		}
+	}
+	return ECPointJacobian::multiply(curve->getN(), G).isInfinity();
+}
+
+/// Signs through a pool of the signature's parameters and through a pool made for 2G.
+/** Both must give valid signatures: the second pool has the same n and must be refused. */
+bool checkNoncePool(SignatureInterface *signature)
+{
+	EllipticCurvePtr curve = curveOf(signature);
+	ECPoint G = ECPoint::generator(curve.data());
+	ECPoint doubled = G + G;
+
+	CryptoGeneratorInterface *other = CryptoGeneratorFactory::cryptoGeneratorByYear(2012);
+	other->setParameters(signature->getParameters()->getParameters());
+	other->setParameter("Gx", doubled.getX());
+	other->setParameter("Gy", doubled.getY());
+
+	const int capacity = 4;
+	NoncePool pool(2012, signature->getParameters(), capacity);
+	NoncePool otherPool(2012, other, capacity);
+	delete other;
+	while (pool.size() < capacity || otherPool.size() < capacity)
+	{
+		QThread::yieldCurrentThread();
+	}
+
+	bool result = true;
+	NoncePool *pools[] = {&pool, &otherPool};
+	for (unsigned int i = 0; i < sizeof(pools) / sizeof(pools[0]); i++)
+	{
+		signature->setNoncePool(pools[i]);
+		for (int j = 0; j < capacity; j++)
+		{
+			result = signature->calculateSign() && signature->verifySign() && result;
+		}
+	}
+	signature->setNoncePool(0);
+	return result;
+}
+
 int main(int argc, char *argv[])
 {
 	QCoreApplication(argc, argv);
 
 	srand(time(NULL));
 
+	big_int two = 2;
+	qDebug() << "Montgomery" << checkField(Function::big_intFromByteArray(QByteArray::fromHex(
+			"8000000000000000000000000000000000000000000000000000000000000431")), PrimeField::Montgomery);
+	qDebug() << "Mersenne" << checkField(power(two, 521) - 1, PrimeField::Mersenne);
+	qDebug() << "PseudoMersenne" << checkField(power(two, 256) - 617, PrimeField::PseudoMersenne)
+			 << checkField(power(two, 512) - 569, PrimeField::PseudoMersenne);
+
 	SignatureInterface *cp = SignatureFactory::signatureByYear(2012);
 	cp->generateNewParameters();
 	cp->setMessage("Hello World");
@@ -28,6 +159,9 @@ int main(int argc, char *argv[])
 	}
 	qDebug() << cp->getSign().toHex();
 	qDebug() << cp->getSign().toHex().length();
+	qDebug() << "multiply" << checkMultiply(cp);
+	bool poolSignsCorrectly = checkNoncePool(cp);
+	qDebug() << "nonce pool" << poolSignsCorrectly;
 
 	SignatureInterface *cp1 = SignatureFactory::signatureByYear(2012);
 	cp1->setMessage("Hello World");
@@ -0,0 +1,113 @@
+#include "noncepool.h"
+
+#include "signaturefactory.h"
+#include "signatureinterface.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QThread>
+
+class NoncePool::Filler : public QThread
+{
+public:
+	Filler(NoncePool *pool, SignatureInterface *signature);
+	~Filler();
+
+protected:
+	void run();
+
+private:
+	NoncePool *pool;
+	SignatureInterface *signature;
+};
+
+NoncePool::Filler::Filler(NoncePool *pool, SignatureInterface *signature)
+	: pool(pool), signature(signature)
+{
+}
+
+NoncePool::Filler::~Filler()
+{
+	delete signature;
+	signature = 0;
+}
+
+void NoncePool::Filler::run()
+{
+	while (pool->waitForSpace())
+	{
+		pool->put(signature->generateNonce());
+	}
+}
+
+NoncePool::NoncePool(int year, CryptoGeneratorInterface *parameters, int capacity)
+	: year(year), capacity(qMax(1, capacity)), stopping(false)
+{
+	SignatureInterface *signature = SignatureFactory::signatureWithParameters(year, parameters);
+	domainKey = signature->domainKey();
+
+	filler = 0;
+	if (!signature->parametersAreSupported())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported, the pool stays empty";
+		delete signature;
+		return;
+	}
+	filler = new Filler(this, signature);
+	filler->start();
+}
+
+NoncePool::~NoncePool()
+{
+	{
+		QMutexLocker locker(&mutex);
+		stopping = true;
+		notFull.wakeAll();
+	}
+	if (filler)
+	{
+		filler->wait();
+		delete filler;
+		filler = 0;
+	}
+}
+
+bool NoncePool::take(QPair<big_int, big_int> &nonce)
+{
+	QMutexLocker locker(&mutex);
+	if (nonces.isEmpty())
+	{
+		return false;
+	}
+	nonce = nonces.takeFirst();
+	notFull.wakeAll();
+	return true;
+}
+
+bool NoncePool::isMadeFor(int year, const QByteArray &domainKey) const
+{
+	return this->year == year && this->domainKey == domainKey;
+}
+
+int NoncePool::size()
+{
+	QMutexLocker locker(&mutex);
+	return nonces.size();
+}
+
+/// Blocks the filler while the pool is full; false means the pool stops.
+bool NoncePool::waitForSpace()
+{
+	QMutexLocker locker(&mutex);
+	while (!stopping && nonces.size() >= capacity)
+	{
+		notFull.wait(&mutex);
+	}
+	return !stopping;
+}
+
+void NoncePool::put(const QPair<big_int, big_int> &nonce)
+{
+	QMutexLocker locker(&mutex);
+	nonces.append(nonce);
+}
@@ -0,0 +1,477 @@
+#include "primefield.h"
+
+#include <string.h>
+
+static inline quint64 addCarry(quint64 left, quint64 right, quint64 &carry)
+{
+	quint64 sum = left + carry;
+	quint64 nextCarry = (sum < carry) ? 1 : 0;
+	sum += right;
+	nextCarry += (sum < right) ? 1 : 0;
+	carry = nextCarry;
+	return sum;
+}
+
+static inline quint64 subBorrow(quint64 left, quint64 right, quint64 &borrow)
+{
+	quint64 difference = left - right - borrow;
+	borrow = ((left < right) || (left - right < borrow)) ? 1 : 0;
+	return difference;
+}
+
+/// Returns the low half of left * right + addend + carry, the high half goes to carry.
+static inline quint64 mulAdd(quint64 left, quint64 right, quint64 addend, quint64 &carry)
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 product = (unsigned __int128)left * right + addend + carry;
+	carry = quint64(product >> 64);
+	return quint64(product);
+#else
+	quint64 leftLow = left & 0xFFFFFFFF, leftHigh = left >> 32;
+	quint64 rightLow = right & 0xFFFFFFFF, rightHigh = right >> 32;
+	quint64 lowLow = leftLow * rightLow;
+	quint64 lowHigh = leftLow * rightHigh;
+	quint64 highLow = leftHigh * rightLow;
+	quint64 highHigh = leftHigh * rightHigh;
+	quint64 middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + (highLow & 0xFFFFFFFF);
+	quint64 low = (lowLow & 0xFFFFFFFF) | (middle << 32);
+	quint64 high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+	quint64 extra = 0;
+	low = addCarry(low, addend, extra);
+	high += extra;
+	extra = 0;
+	low = addCarry(low, carry, extra);
+	high += extra;
+	carry = high;
+	return low;
+#endif
+}
+
+static quint64 addLimbs(quint64 *result, const quint64 *left, const quint64 *right, int count)
+{
+	quint64 carry = 0;
+	for (int i = 0; i < count; i++)
+	{
+		result[i] = addCarry(left[i], right[i], carry);
+	}
+	return carry;
+}
+
+static quint64 subLimbs(quint64 *result, const quint64 *left, const quint64 *right, int count)
+{
+	quint64 borrow = 0;
+	for (int i = 0; i < count; i++)
+	{
+		result[i] = subBorrow(left[i], right[i], borrow);
+	}
+	return borrow;
+}
+
+static int compareLimbs(const quint64 *left, const quint64 *right, int count)
+{
+	for (int i = count - 1; i >= 0; i--)
+	{
+		if (left[i] != right[i])
+		{
+			return (left[i] < right[i]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+static void mulLimbs(quint64 *result, const quint64 *left, int leftCount, const quint64 *right, int rightCount)
+{
+	memset(result, 0, (leftCount + rightCount) * sizeof(quint64));
+	for (int i = 0; i < leftCount; i++)
+	{
+		quint64 carry = 0;
+		for (int j = 0; j < rightCount; j++)
+		{
+			result[i + j] = mulAdd(left[i], right[j], result[i + j], carry);
+		}
+		result[i + rightCount] = carry;
+	}
+}
+
+static void shiftRightOne(quint64 *value, int count, quint64 topBit)
+{
+	for (int i = 0; i < count - 1; i++)
+	{
+		value[i] = (value[i] >> 1) | (value[i + 1] << 63);
+	}
+	value[count - 1] = (value[count - 1] >> 1) | (topBit << 63);
+}
+
+/// Copies the bits [shift, shift + 64 * count) of value to result.
+static void shiftRightBits(const quint64 *value, int valueCount, int shift, quint64 *result, int count)
+{
+	int limbShift = shift / 64;
+	int bitShift = shift % 64;
+	for (int i = 0; i < count; i++)
+	{
+		int index = i + limbShift;
+		quint64 low = (index < valueCount) ? value[index] : 0;
+		quint64 high = (index + 1 < valueCount) ? value[index + 1] : 0;
+		result[i] = bitShift ? ((low >> bitShift) | (high << (64 - bitShift))) : low;
+	}
+}
+
+/// Clears all bits of value starting from the given one.
+static void truncateBits(quint64 *value, int count, int bits)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (i * 64 >= bits)
+		{
+			value[i] = 0;
+		}
+		else if ((i + 1) * 64 > bits)
+		{
+			value[i] &= (quint64(1) << (bits - i * 64)) - 1;
+		}
+	}
+}
+
+FieldElement::FieldElement()
+{
+	memset(limbs, 0, sizeof(limbs));
+}
+
+bool FieldElement::isZero() const
+{
+	for (int i = 0; i < MaxLimbs; i++)
+	{
+		if (limbs[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool operator==(const FieldElement &left, const FieldElement &right)
+{
+	return compareLimbs(left.limbs, right.limbs, FieldElement::MaxLimbs) == 0;
+}
+
+bool operator!=(const FieldElement &left, const FieldElement &right)
+{
+	return !(left == right);
+}
+
+PrimeField::PrimeField()
+	: n(0), reductionType(Montgomery), bits(0), c(0), pInverse(0)
+{
+	memset(p, 0, sizeof(p));
+}
+
+PrimeField::PrimeField(const big_int &modulus)
+	: n(0), reductionType(Montgomery), bits(0), c(0), pInverse(0)
+{
+	memset(p, 0, sizeof(p));
+
+	if (modulus < 3 || !modulus.is_odd() || modulus.length() > 64 * FieldElement::MaxLimbs)
+	{
+		return;
+	}
+	n = (modulus.length() + 63) / 64;
+	limbsFromBigInt(modulus, p, n);
+	modulusValue = modulus;
+
+	bits = modulus.length();
+	big_int difference = (big_int(1) << bits) - modulus;
+	if (difference == 1)
+	{
+		reductionType = Mersenne;
+		c = 1;
+	}
+	else if (difference.length() <= 32 && bits >= 128)
+	{
+		/* c < 2^32 is small against p, so two folds leave less than
+			2^bits + 2^65 < 2p. */
+		reductionType = PseudoMersenne;
+		limbsFromBigInt(difference, &c, 1);
+	}
+	else
+	{
+		/* Newton iteration doubles the number of correct low bits of p^(-1)
+			mod 2^64 on each step, starting from 1 correct bit for odd p. */
+		quint64 inverse = 1;
+		for (int i = 0; i < 6; i++)
+		{
+			inverse *= 2 - p[0] * inverse;
+		}
+		pInverse = 0 - inverse;
+		limbsFromBigInt(mod(big_int(1) << (64 * n), modulus), montgomeryOne.limbs, n);
+		limbsFromBigInt(mod(big_int(1) << (128 * n), modulus), montgomerySquare.limbs, n);
+		limbsFromBigInt(mod(big_int(1) << (192 * n), modulus), montgomeryCube.limbs, n);
+	}
+}
+
+bool PrimeField::isValid() const
+{
+	return n != 0;
+}
+
+PrimeField::Reduction PrimeField::reduction() const
+{
+	return reductionType;
+}
+
+int PrimeField::limbCount() const
+{
+	return n;
+}
+
+const big_int &PrimeField::modulus() const
+{
+	return modulusValue;
+}
+
+FieldElement PrimeField::fromBigInt(const big_int &value) const
+{
+	FieldElement result;
+	if (isValid())
+	{
+		limbsFromBigInt(mod(value, modulusValue), result.limbs, n);
+		if (reductionType == Montgomery)
+		{
+			mulMontgomery(result.limbs, montgomerySquare.limbs, result.limbs);
+		}
+	}
+	return result;
+}
+
+big_int PrimeField::toBigInt(const FieldElement &value) const
+{
+	if (reductionType == Montgomery && isValid())
+	{
+		FieldElement unit;
+		unit.limbs[0] = 1;
+		FieldElement result;
+		mulMontgomery(value.limbs, unit.limbs, result.limbs);
+		return limbsToBigInt(result.limbs, n);
+	}
+	return limbsToBigInt(value.limbs, n);
+}
+
+FieldElement PrimeField::zero() const
+{
+	return FieldElement();
+}
+
+FieldElement PrimeField::one() const
+{
+	if (reductionType == Montgomery)
+	{
+		return montgomeryOne;
+	}
+	FieldElement result;
+	result.limbs[0] = 1;
+	return result;
+}
+
+FieldElement PrimeField::add(const FieldElement &left, const FieldElement &right) const
+{
+	FieldElement result;
+	quint64 carry = addLimbs(result.limbs, left.limbs, right.limbs, n);
+	if (carry || compareLimbs(result.limbs, p, n) >= 0)
+	{
+		subLimbs(result.limbs, result.limbs, p, n);
+	}
+	return result;
+}
+
+FieldElement PrimeField::sub(const FieldElement &left, const FieldElement &right) const
+{
+	FieldElement result;
+	if (subLimbs(result.limbs, left.limbs, right.limbs, n))
+	{
+		addLimbs(result.limbs, result.limbs, p, n);
+	}
+	return result;
+}
+
+FieldElement PrimeField::neg(const FieldElement &value) const
+{
+	return sub(zero(), value);
+}
+
+FieldElement PrimeField::mul(const FieldElement &left, const FieldElement &right) const
+{
+	FieldElement result;
+	if (reductionType == Montgomery)
+	{
+		mulMontgomery(left.limbs, right.limbs, result.limbs);
+		return result;
+	}
+	quint64 wide[2 * FieldElement::MaxLimbs];
+	mulLimbs(wide, left.limbs, n, right.limbs, n);
+	reduceSpecialForm(wide, result);
+	return result;
+}
+
+FieldElement PrimeField::sqr(const FieldElement &value) const
+{
+	return mul(value, value);
+}
+
+/// Binary extended Euclid: keeps x1 * value = u and x2 * value = v modulo p.
+/** It works on the stored limbs, so in the Montgomery case it yields
+	(a R)^(-1) = a^(-1) R^(-1), which one multiplication by R^3 turns
+	into a^(-1) R. */
+FieldElement PrimeField::inv(const FieldElement &value) const
+{
+	if (value.isZero())
+	{
+		return zero();
+	}
+
+	FieldElement u = value;
+	FieldElement v;
+	memcpy(v.limbs, p, sizeof(p));
+	FieldElement unit;
+	unit.limbs[0] = 1;
+	FieldElement x1 = unit;
+	FieldElement x2 = zero();
+
+	while (u != unit && v != unit)
+	{
+		while (!(u.limbs[0] & 1))
+		{
+			shiftRightOne(u.limbs, n, 0);
+			quint64 carry = (x1.limbs[0] & 1) ? addLimbs(x1.limbs, x1.limbs, p, n) : 0;
+			shiftRightOne(x1.limbs, n, carry);
+		}
+		while (!(v.limbs[0] & 1))
+		{
+			shiftRightOne(v.limbs, n, 0);
+			quint64 carry = (x2.limbs[0] & 1) ? addLimbs(x2.limbs, x2.limbs, p, n) : 0;
+			shiftRightOne(x2.limbs, n, carry);
+		}
+		if (compareLimbs(u.limbs, v.limbs, n) >= 0)
+		{
+			subLimbs(u.limbs, u.limbs, v.limbs, n);
+			x1 = sub(x1, x2);
+		}
+		else
+		{
+			subLimbs(v.limbs, v.limbs, u.limbs, n);
+			x2 = sub(x2, x1);
+		}
+	}
+	FieldElement result = (u == unit) ? x1 : x2;
+	if (reductionType == Montgomery)
+	{
+		mulMontgomery(result.limbs, montgomeryCube.limbs, result.limbs);
+	}
+	return result;
+}
+
+/// Montgomery product left * right * 2^(-64 n) mod p, CIOS form.
+/** Multiplication and reduction are interleaved limb by limb, so the
+	accumulator never grows beyond n + 2 limbs. result may alias an operand. */
+void PrimeField::mulMontgomery(const quint64 *left, const quint64 *right, quint64 *result) const
+{
+	quint64 t[FieldElement::MaxLimbs + 2];
+	memset(t, 0, sizeof(t));
+	for (int i = 0; i < n; i++)
+	{
+		quint64 carry = 0;
+		for (int j = 0; j < n; j++)
+		{
+			t[j] = mulAdd(left[j], right[i], t[j], carry);
+		}
+		quint64 extra = 0;
+		t[n] = addCarry(t[n], carry, extra);
+		t[n + 1] = extra;
+
+		quint64 m = t[0] * pInverse;
+		carry = 0;
+		mulAdd(m, p[0], t[0], carry);
+		for (int j = 1; j < n; j++)
+		{
+			t[j - 1] = mulAdd(m, p[j], t[j], carry);
+		}
+		extra = 0;
+		t[n - 1] = addCarry(t[n], carry, extra);
+		t[n] = t[n + 1] + extra;
+	}
+
+	if (t[n] || compareLimbs(t, p, n) >= 0)
+	{
+		subLimbs(t, t, p, n);
+	}
+	memcpy(result, t, n * sizeof(quint64));
+}
+
+/// Reduction modulo p = 2^bits - c of a 2n-limb product x < p^2.
+/** With x = H * 2^bits + L we have x = L + c * H (mod p); two such folds
+	leave a value below 2p. */
+void PrimeField::reduceSpecialForm(const quint64 *wide, FieldElement &result) const
+{
+	quint64 once[FieldElement::MaxLimbs + 1];
+	foldSpecialForm(wide, 2 * n, once);
+	quint64 twice[FieldElement::MaxLimbs + 1];
+	foldSpecialForm(once, n + 1, twice);
+
+	quint64 extendedP[FieldElement::MaxLimbs + 1];
+	memcpy(extendedP, p, n * sizeof(quint64));
+	extendedP[n] = 0;
+	while (compareLimbs(twice, extendedP, n + 1) >= 0)
+	{
+		subLimbs(twice, twice, extendedP, n + 1);
+	}
+	memcpy(result.limbs, twice, n * sizeof(quint64));
+}
+
+/// result (n + 1 limbs) = (value mod 2^bits) + c * (value >> bits).
+void PrimeField::foldSpecialForm(const quint64 *value, int count, quint64 *result) const
+{
+	quint64 high[FieldElement::MaxLimbs + 1];
+	shiftRightBits(value, count, bits, high, n + 1);
+
+	memcpy(result, value, n * sizeof(quint64));
+	result[n] = 0;
+	truncateBits(result, n, bits);
+
+	if (reductionType == Mersenne)
+	{
+		addLimbs(result, result, high, n + 1);
+		return;
+	}
+
+	quint64 carry = 0;
+	quint64 product[FieldElement::MaxLimbs + 1];
+	for (int i = 0; i < n; i++)
+	{
+		product[i] = mulAdd(high[i], c, 0, carry);
+	}
+	product[n] = carry + high[n] * c;
+	addLimbs(result, result, product, n + 1);
+}
+
+void PrimeField::limbsFromBigInt(const big_int &value, quint64 *limbs, int count)
+{
+	memset(limbs, 0, count * sizeof(quint64));
+	const int digitBits = _Internal::bits_per_digit;
+	int digits = (value.length() + digitBits - 1) / digitBits;
+	const _Internal::digit *data = value._digits();
+	for (int i = 0; i < digits && (i * digitBits) / 64 < count; i++)
+	{
+		limbs[(i * digitBits) / 64] |= quint64(data[i]) << ((i * digitBits) % 64);
+	}
+}
+
+big_int PrimeField::limbsToBigInt(const quint64 *limbs, int count)
+{
+	big_int result = 0;
+	for (int i = count - 1; i >= 0; i--)
+	{
+		result <<= 32;
+		result += big_int((unsigned int)(limbs[i] >> 32));
+		result <<= 32;
+		result += big_int((unsigned int)(limbs[i] & 0xFFFFFFFF));
+	}
+	return result;
+}
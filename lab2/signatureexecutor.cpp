@@ -0,0 +1,185 @@
+#include "signatureexecutor.h"
+
+#include "signaturefactory.h"
+#include "signatureinterface.h"
+
+#include <QBuffer>
+#include <QMutexLocker>
+
+SignatureTask::SignatureTask()
+	: type(Verify), key(0), result(false)
+{
+}
+
+class SignatureExecutor::Worker : public QThread
+{
+public:
+	Worker(SignatureExecutor *executor, int index, SignatureInterface *signature);
+	~Worker();
+
+	QMutex queueMutex;
+	QList<int> queue;
+
+protected:
+	void run();
+
+private:
+	void execute(SignatureTask &task);
+
+	SignatureExecutor *executor;
+	int index;
+	SignatureInterface *signature;
+	QBuffer buffer;
+};
+
+SignatureExecutor::Worker::Worker(SignatureExecutor *executor, int index, SignatureInterface *signature)
+	: executor(executor), index(index), signature(signature)
+{
+}
+
+SignatureExecutor::Worker::~Worker()
+{
+	delete signature;
+	signature = 0;
+}
+
+void SignatureExecutor::Worker::run()
+{
+	int generation = 0;
+	while (executor->waitForBatch(generation))
+	{
+		int task;
+		while (executor->takeTask(index, task))
+		{
+			execute(executor->batch[task]);
+			executor->taskDone();
+		}
+	}
+}
+
+void SignatureExecutor::Worker::execute(SignatureTask &task)
+{
+	buffer.close();
+	buffer.setData(task.message);
+	signature->setInputDevice(&buffer);
+
+	switch (task.type)
+	{
+		case SignatureTask::Sign:
+		{
+			signature->setSecretKey(task.key);
+			task.result = signature->calculateSign();
+			task.signature = signature->getSign();
+			break;
+		}
+		case SignatureTask::Verify:
+		default:
+		{
+			signature->setPublicKey(task.key);
+			signature->setSign(task.signature);
+			task.result = signature->verifySign();
+			break;
+		}
+	}
+}
+
+SignatureExecutor::SignatureExecutor(int year, CryptoGeneratorInterface *parameters, int threadCount)
+	: batch(0), batchGeneration(0), remainingTasks(0), stopping(false)
+{
+	for (int i = 0; i < qMax(1, threadCount); i++)
+	{
+		SignatureInterface *signature = SignatureFactory::signatureWithParameters(year, parameters);
+
+		Worker *worker = new Worker(this, i, signature);
+		workers.append(worker);
+		worker->start();
+	}
+}
+
+SignatureExecutor::~SignatureExecutor()
+{
+	{
+		QMutexLocker locker(&mutex);
+		stopping = true;
+		batchStarted.wakeAll();
+	}
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->wait();
+		delete workers[i];
+	}
+	workers.clear();
+}
+
+int SignatureExecutor::threadCount() const
+{
+	return workers.size();
+}
+
+void SignatureExecutor::run(QVector<SignatureTask> &tasks)
+{
+	if (tasks.isEmpty())
+	{
+		return;
+	}
+
+	QMutexLocker locker(&mutex);
+	batch = tasks.data();
+	remainingTasks = tasks.size();
+	for (int i = 0; i < workers.size(); i++)
+	{
+		QMutexLocker queueLocker(&workers[i]->queueMutex);
+		int begin = tasks.size() * i / workers.size();
+		int end = tasks.size() * (i + 1) / workers.size();
+		for (int task = begin; task < end; task++)
+		{
+			workers[i]->queue.append(task);
+		}
+	}
+
+	batchGeneration++;
+	batchStarted.wakeAll();
+	while (remainingTasks > 0)
+	{
+		batchFinished.wait(&mutex);
+	}
+	batch = 0;
+}
+
+/// Own tasks are taken from the back of the queue, stolen ones from the front.
+bool SignatureExecutor::takeTask(int worker, int &task)
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		Worker *queueOwner = workers[(worker + i) % workers.size()];
+		QMutexLocker locker(&queueOwner->queueMutex);
+		if (!queueOwner->queue.isEmpty())
+		{
+			task = (i == 0) ? queueOwner->queue.takeLast() : queueOwner->queue.takeFirst();
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Blocks until a batch newer than generation is started; false means the executor stops.
+bool SignatureExecutor::waitForBatch(int &generation)
+{
+	QMutexLocker locker(&mutex);
+	while (!stopping && batchGeneration == generation)
+	{
+		batchStarted.wait(&mutex);
+	}
+	generation = batchGeneration;
+	return !stopping;
+}
+
+void SignatureExecutor::taskDone()
+{
+	QMutexLocker locker(&mutex);
+	remainingTasks--;
+	if (remainingTasks == 0)
+	{
+		batchFinished.wakeAll();
+	}
+}
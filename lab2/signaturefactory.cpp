@@ -3,6 +3,9 @@
 #include "signaturegost_1994.h"
 #include "signaturegost_2012.h"
 
+#include "cryptogeneratorfactory.h"
+#include "cryptogeneratorinterface.h"
+
 SignatureInterface *SignatureFactory::signatureByYear(int year)
 {
 	switch (year)
@@ -18,3 +21,12 @@ SignatureInterface *SignatureFactory::signatureByYear(int year)
 		}
 	}
 }
+
+SignatureInterface *SignatureFactory::signatureWithParameters(int year, CryptoGeneratorInterface *parameters)
+{
+	CryptoGeneratorInterface *copy = CryptoGeneratorFactory::cryptoGeneratorByYear(year);
+	copy->setParameters(parameters->getParameters());
+	SignatureInterface *signature = signatureByYear(year);
+	signature->setParameters(copy);
+	return signature;
+}
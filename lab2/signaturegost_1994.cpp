@@ -4,10 +4,11 @@
 
 #include <QDebug>
 
-SignatureGost_1994::SignatureGost_1994() : SignatureInterface()
+SignatureGost_1994::SignatureGost_1994() : SignatureInterface(), domainChanged(true)
 {
 }
 
+/// Only marks the domain as changed, it is resolved again on the next use.
 void SignatureGost_1994::setParameter(const QByteArray &key, const big_int &value)
 {
 	SignatureInterface::setParameter(key, value);
@@ -15,18 +16,25 @@ void SignatureGost_1994::setParameter(const QByteArray &key, const big_int &valu
 	{
 		modul = value;
 	}
+	domainChanged = true;
 }
 
 void SignatureGost_1994::setParameters(CryptoGeneratorInterface *parameters)
 {
 	SignatureInterface::setParameters(parameters);
-	modul = getParameter("q");
+	domainChanged = true;
+	modul = domain().q;
 }
 
 big_int SignatureGost_1994::calculateR(const big_int &k)
 {
-	big_int r = power_mod(getParameter("alpha"), k, getParameter("p"));
-	return mod(r, getParameter("q"));
+	return calculateR(domain(), k);
+}
+
+big_int SignatureGost_1994::calculateR(const Domain &domain, const big_int &k)
+{
+	big_int r = domain.alphaTable->power(k);
+	return mod(r, domain.q);
 }
 
 big_int SignatureGost_1994::calculateV()
@@ -36,10 +44,80 @@ big_int SignatureGost_1994::calculateV()
 
 big_int SignatureGost_1994::calculateU(const big_int &z1, const big_int &z2)
 {
-	big_int u = power_mod( getParameter("alpha"), z1,  getParameter("p"));
-	u *= power_mod(publicKey, z2, getParameter("p"));
-	u = mod(u, getParameter("p"));
-	return mod(u, modul);
+	return calculateU(domain(), publicKey, z1, z2);
+}
+
+big_int SignatureGost_1994::calculateU(const Domain &domain, const big_int &publicKey,
+									   const big_int &z1, const big_int &z2)
+{
+	big_int u = power_mod_dual(domain.alpha, z1, publicKey, z2, domain.p);
+	return mod(u, domain.q);
+}
+
+QByteArray SignatureGost_1994::signDigest(const QByteArray &digest)
+{
+	if (cryptoGenerator == 0 || !secretKeyIsCorrect())
+	{
+		return QByteArray();
+	}
+	return sign(domain(), secretKey, digest);
+}
+
+QByteArray SignatureGost_1994::domainKey()
+{
+	return domain().key;
+}
+
+bool SignatureGost_1994::parametersAreSupported()
+{
+	return cryptoGenerator != 0 && domain().isValid();
+}
+
+/// Signs a precomputed digest without touching any object state.
+/** The domain comes from domain() of a configured signature and may be shared
+	between threads. */
+QByteArray SignatureGost_1994::sign(const Domain &domain, const big_int &secretKey, const QByteArray &digest)
+{
+	if (!domain.isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		return QByteArray();
+	}
+	const big_int &q = domain.q;
+	big_int e = hashFromDigest(digest, q);
+	big_int r = 0;
+	big_int s = 0;
+	do
+	{
+		big_int k = big_int::random_in_range(q);
+		r = calculateR(domain, k);
+		if (!r.is_null())
+		{
+			s = mod(secretKey * r + k * e, q);
+		}
+	} while (r.is_null() || s.is_null());
+	return joinSign(r, s, q);
+}
+
+bool SignatureGost_1994::verify(const Domain &domain, const big_int &publicKey, const QByteArray &digest,
+								const QByteArray &sign)
+{
+	if (!domain.isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		return false;
+	}
+	const big_int &q = domain.q;
+	big_int r;
+	big_int s;
+	if (!splitSign(sign, q, r, s))
+	{
+		return false;
+	}
+	big_int v = inverse_mod(hashFromDigest(digest, q), q);
+	big_int z1 = mod(s * v, q);
+	big_int z2 = mod((q - r) * v, q);
+	return calculateU(domain, publicKey, z1, z2) == r;
 }
 
 void SignatureGost_1994::generateNewKeys()
@@ -49,14 +127,22 @@ void SignatureGost_1994::generateNewKeys()
 		qDebug() << Q_FUNC_INFO << "CryptoGenerator doesn't exist";
 		return;
 	}
-	modul = getParameter("q");
+	domainChanged = true;
+	modul = domain().q;
+	if (!domain().isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		secretKey = 0;
+		publicKey = 0;
+		return;
+	}
 	generateSecretKey();
-	publicKey = power_mod(getParameter("alpha"), secretKey, getParameter("p"));
+	publicKey = domain().alphaTable->power(secretKey);
 }
 
 void SignatureGost_1994::generateSecretKey()
 {
-	secretKey = big_int::random_in_range(getParameter("q"));
+	secretKey = big_int::random_in_range(domain().q);
 }
 
 int SignatureGost_1994::gostYear()
@@ -66,5 +152,39 @@ int SignatureGost_1994::gostYear()
 
 bool SignatureGost_1994::secretKeyIsCorrect()
 {
-	return (secretKey < getParameter("q"));
+	return (secretKey < domain().q);
+}
+
+const SignatureGost_1994::Domain &SignatureGost_1994::domain()
+{
+	if (domainChanged && cryptoGenerator != 0)
+	{
+		resolvedDomain.p = getParameter("p");
+		resolvedDomain.q = getParameter("q");
+		resolvedDomain.alpha = getParameter("alpha");
+		resolvedDomain.alphaTable.clear();
+		if (resolvedDomain.p > 1 && resolvedDomain.q > 1)
+		{
+			resolvedDomain.alphaTable = FixedBasePowerTable::forBase(resolvedDomain.alpha, resolvedDomain.p,
+																	 resolvedDomain.q.length());
+		}
+		else
+		{
+			qDebug() << Q_FUNC_INFO << "p and q must be greater than 1";
+		}
+		resolvedDomain.key.clear();
+		const big_int values[] = {resolvedDomain.p, resolvedDomain.q, resolvedDomain.alpha};
+		for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+		{
+			resolvedDomain.key.append(Function::big_intToByteArray(values[i]).toHex());
+			resolvedDomain.key.append(':');
+		}
+		domainChanged = false;
+	}
+	return resolvedDomain;
+}
+
+bool SignatureGost_1994::Domain::isValid() const
+{
+	return p > 1 && q > 1 && !alphaTable.isNull();
 }
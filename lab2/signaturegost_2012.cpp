@@ -1,10 +1,13 @@
 #include "signaturegost_2012.h"
 
+#include "ecmultiscalar.h"
+
 #include "function.h"
 
 #include <QDebug>
+#include <QMap>
 
-SignatureGost_2012::SignatureGost_2012() : SignatureInterface()
+SignatureGost_2012::SignatureGost_2012() : SignatureInterface(), domainChanged(true)
 {
 }
 
@@ -15,33 +18,179 @@ void SignatureGost_2012::setParameter(const QByteArray &key, const big_int &valu
 	{
 		modul = value;
 	}
-	G = ECPoint(getParameter("a"), getParameter("b"),
-				getParameter("Gx"), getParameter("Gy"),
-				getParameter("p"));
-
+	domainChanged = true;
 }
 
 void SignatureGost_2012::setParameters(CryptoGeneratorInterface *parameters)
 {
 	SignatureInterface::setParameters(parameters);
-	modul = getParameter("n");
-	G = ECPoint(getParameter("a"), getParameter("b"),
-				getParameter("Gx"), getParameter("Gy"),
-				getParameter("p"));
+	domainChanged = true;
+	modul = domain().curve->getN();
 }
 
 big_int SignatureGost_2012::calculateV()
 {
-	return inverse_mod(hash, getParameter("n"));
+	return inverse_mod(hash, modul);
 }
 
+/// -1 for the point at infinity, it never equals r read from a signature.
 big_int SignatureGost_2012::calculateU(const big_int &z1, const big_int &z2)
 {
-	ECPoint Q = ECPoint::decompressionCoordinate(publicKey,
-												 getParameter("a"), getParameter("b"),
-												 getParameter("p"));
-	ECPoint C = z1 * G + z2 *Q;
-	return mod(C.x, modul);
+	ECPointJacobian C = calculateC(domain(), publicKey, z1, z2);
+	if (C.isInfinity())
+	{
+		return -1;
+	}
+	return mod(C.toAffine().getX(), modul);
+}
+
+/// z1 * G + z2 * Q in one interleaved multiplication, infinity for an invalid public key.
+ECPointJacobian SignatureGost_2012::calculateC(const Domain &domain, const big_int &publicKey,
+											   const big_int &z1, const big_int &z2)
+{
+	QSharedPointer<const ECPublicKey> Q = ECPublicKey::forKey(publicKey, domain.curve);
+	if (!Q->isValid())
+	{
+		return ECPointJacobian(domain.curve.data());
+	}
+	ECMultiScalar C;
+	C.add(z1, *domain.generatorTable);
+	C.add(z2, *Q);
+	return C.calculate();
+}
+
+QByteArray SignatureGost_2012::signDigest(const QByteArray &digest)
+{
+	if (cryptoGenerator == 0 || !secretKeyIsCorrect())
+	{
+		return QByteArray();
+	}
+	return sign(domain(), secretKey, digest);
+}
+
+bool SignatureGost_2012::parametersAreSupported()
+{
+	return cryptoGenerator != 0 && domain().isValid();
+}
+
+QByteArray SignatureGost_2012::domainKey()
+{
+	return domain().key;
+}
+
+/// Signs a precomputed digest without touching any object state.
+/** The domain comes from domain() of a configured signature and may be shared
+	between threads. */
+QByteArray SignatureGost_2012::sign(const Domain &domain, const big_int &secretKey, const QByteArray &digest)
+{
+	if (!domain.isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		return QByteArray();
+	}
+	const big_int &n = domain.curve->getN();
+	big_int e = hashFromDigest(digest, n);
+	big_int r = 0;
+	big_int s = 0;
+	do
+	{
+		big_int k = big_int::random_in_range(n);
+		r = calculateR(domain, k);
+		if (!r.is_null())
+		{
+			s = mod(secretKey * r + k * e, n);
+		}
+	} while (r.is_null() || s.is_null());
+	return joinSign(r, s, n);
+}
+
+bool SignatureGost_2012::verify(const Domain &domain, const big_int &publicKey, const QByteArray &digest,
+								const QByteArray &sign)
+{
+	if (!domain.isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		return false;
+	}
+	const big_int &n = domain.curve->getN();
+	big_int r;
+	big_int s;
+	if (!splitSign(sign, n, r, s))
+	{
+		return false;
+	}
+	big_int v = inverse_mod(hashFromDigest(digest, n), n);
+	big_int z1 = mod(s * v, n);
+	big_int z2 = mod((n - r) * v, n);
+	ECPointJacobian C = calculateC(domain, publicKey, z1, z2);
+	return !C.isInfinity() && mod(C.toAffine().getX(), n) == r;
+}
+
+/// Verifies many signatures at once with the current parameters.
+/** Items with the same public key share one decompressed key, all
+	z1 * G + z2 * Q use the shared generator table, and the inversions of the
+	hashes and of the final Z coordinates are batched into one each. */
+QVector<bool> SignatureGost_2012::verifyBatch(const QVector<SignatureBatchItem> &items)
+{
+	QVector<bool> result(items.size(), false);
+	if (cryptoGenerator == 0 || items.isEmpty() || !parametersAreSupported())
+	{
+		return result;
+	}
+	const Domain &parameters = domain();
+
+	QVector<int> indices;
+	QVector<big_int> hashes;
+	QVector<big_int> rs;
+	QVector<big_int> ss;
+	QMap<QByteArray, QVector<int> > groups;
+	for (int i = 0; i < items.size(); i++)
+	{
+		const SignatureBatchItem &item = items[i];
+		big_int r;
+		big_int s;
+		if (!splitSign(item.signature, modul, r, s))
+		{
+			continue;
+		}
+		groups[Function::big_intToByteArray(item.publicKey)].append(indices.size());
+		indices.append(i);
+		hashes.append(hashFromDigest(item.hash, modul));
+		rs.append(r);
+		ss.append(s);
+	}
+	if (indices.isEmpty())
+	{
+		return result;
+	}
+
+	QVector<big_int> vs = Function::inverseModBatch(hashes, modul);
+	QVector<ECPointJacobian> points(indices.size());
+	for (QMap<QByteArray, QVector<int> >::const_iterator group = groups.constBegin(); group != groups.constEnd(); ++group)
+	{
+		const QVector<int> &members = group.value();
+		QSharedPointer<const ECPublicKey> Q = ECPublicKey::forKey(items[indices[members.first()]].publicKey, parameters.curve);
+		for (int k = 0; k < members.size(); k++)
+		{
+			int j = members[k];
+			if (!Q->isValid())
+			{
+				points[j] = ECPointJacobian(parameters.curve.data());
+				continue;
+			}
+			ECMultiScalar C;
+			C.add(calculateZ1(vs[j], ss[j]), *parameters.generatorTable);
+			C.add(calculateZ2(vs[j], rs[j]), *Q);
+			points[j] = C.calculate();
+		}
+	}
+
+	QVector<ECPoint> affine = ECPointJacobian::toAffine(points);
+	for (int j = 0; j < indices.size(); j++)
+	{
+		result[indices[j]] = !points[j].isInfinity() && (mod(affine[j].getX(), modul) == rs[j]);
+	}
+	return result;
 }
 
 void SignatureGost_2012::generateNewKeys()
@@ -51,19 +200,24 @@ void SignatureGost_2012::generateNewKeys()
 		qDebug() << Q_FUNC_INFO << "CryptoGenerator doesn't exist";
 		return;
 	}
-	modul = getParameter("n");
+	domainChanged = true;
+	modul = domain().curve->getN();
+	if (!domain().isValid())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		secretKey = 0;
+		publicKey = 0;
+		return;
+	}
 	generateSecretKey();
-	G = ECPoint(getParameter("a"), getParameter("b"),
-				getParameter("Gx"), getParameter("Gy"),
-				getParameter("p"));
 
-	ECPoint Q = secretKey * G;
+	ECPoint Q = domain().generatorTable->multiply(secretKey).toAffine();
 	publicKey = ECPoint::compressionCoordinate(Q);
 }
 
 void SignatureGost_2012::generateSecretKey()
 {
-	secretKey = big_int::random_in_range(getParameter("n"));
+	secretKey = big_int::random_in_range(modul);
 }
 
 int SignatureGost_2012::gostYear()
@@ -73,11 +227,53 @@ int SignatureGost_2012::gostYear()
 
 bool SignatureGost_2012::secretKeyIsCorrect()
 {
-	return secretKey < getParameter("n");
+	return secretKey < modul;
 }
 
 big_int SignatureGost_2012::calculateR(const big_int &k)
 {
-	ECPoint C = k * G;
-	return mod(C.x, getParameter("n"));
+	return calculateR(domain(), k);
+}
+
+big_int SignatureGost_2012::calculateR(const Domain &domain, const big_int &k)
+{
+	ECPoint C = domain.generatorTable->multiply(k).toAffine();
+	return mod(C.getX(), domain.curve->getN());
+}
+
+/// Rebuilds the shared curve and its generator table if the parameters have changed.
+const SignatureGost_2012::Domain &SignatureGost_2012::domain()
+{
+	if (domainChanged && cryptoGenerator != 0)
+	{
+		EllipticCurvePtr curve(new EllipticCurve(getParameter("p"), getParameter("a"), getParameter("b"),
+												 getParameter("n"), getParameter("h"),
+												 getParameter("Gx"), getParameter("Gy")));
+		resolvedDomain.curve = curve;
+		resolvedDomain.generatorTable.clear();
+		resolvedDomain.key = curve->key();
+		const big_int values[] = {curve->getN(), getParameter("Gx"), getParameter("Gy")};
+		for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+		{
+			resolvedDomain.key.append(Function::big_intToByteArray(values[i]).toHex());
+			resolvedDomain.key.append(':');
+		}
+		if (curve->field().isValid())
+		{
+			resolvedDomain.generatorTable = ECFixedBaseTable::forPoint(curve, ECPoint::generator(curve.data()),
+																	   curve->getN().length());
+		}
+		else
+		{
+			qDebug() << Q_FUNC_INFO << "p must be an odd prime of at most"
+					 << 64 * FieldElement::MaxLimbs << "bits";
+		}
+		domainChanged = false;
+	}
+	return resolvedDomain;
+}
+
+bool SignatureGost_2012::Domain::isValid() const
+{
+	return !curve.isNull() && !generatorTable.isNull();
 }
@@ -5,6 +5,8 @@
 
 #include "hashfactory.h"
 
+#include "noncepool.h"
+
 #include "function.h"
 
 #include <QBuffer>
@@ -12,7 +14,7 @@
 #include <QDebug>
 
 SignatureInterface::SignatureInterface()
-	: inputDevice(0), cryptoGenerator(0),
+	: inputDevice(0), messageBuffer(0), cryptoGenerator(0), noncePool(0),
 	  secretKey(0), publicKey(0),
 	  signature("")
 {
@@ -22,6 +24,8 @@ SignatureInterface::~SignatureInterface()
 {
 	delete cryptoGenerator;
 	cryptoGenerator = 0;
+	delete messageBuffer;
+	messageBuffer = 0;
 }
 
 void SignatureInterface::setInputDevice(QIODevice *input)
@@ -32,9 +36,13 @@ void SignatureInterface::setInputDevice(QIODevice *input)
 
 void SignatureInterface::setMessage(const QByteArray &message)
 {
-	QBuffer *buffer = new QBuffer;
-	buffer->setData(message);
-	inputDevice = buffer;
+	if (!messageBuffer)
+	{
+		messageBuffer = new QBuffer;
+	}
+	messageBuffer->close();
+	messageBuffer->setData(message);
+	inputDevice = messageBuffer;
 	tryOpenInputDevice();
 }
 
@@ -80,6 +88,7 @@ void SignatureInterface::setParameter(const QByteArray &key, const big_int &valu
 		cryptoGenerator = CryptoGeneratorFactory::cryptoGeneratorByYear(gostYear());
 	}
 	cryptoGenerator->setParameter(key, value);
+	noncePool = 0;
 }
 
 void SignatureInterface::setParameters(CryptoGeneratorInterface *parameters)
@@ -89,6 +98,12 @@ void SignatureInterface::setParameters(CryptoGeneratorInterface *parameters)
 		delete cryptoGenerator;
 	}
 	cryptoGenerator = parameters;
+	noncePool = 0;
+}
+
+big_int SignatureInterface::getModul()
+{
+	return modul;
 }
 
 big_int SignatureInterface::getSecretKey()
@@ -127,33 +142,59 @@ bool SignatureInterface::calculateSign()
 	{
 		return false;
 	}
-	signature = QByteArray();
-
 	QPair<big_int, big_int> signParts = calculateSignParts();
-
-	QByteArray first = Function::big_intToByteArray(signParts.first);
-	QByteArray second = Function::big_intToByteArray(signParts.second);
-
-	quint8 tmp = (modul.length() % 8 == 0) ? 0 : 1;
-	signature += first.rightJustified(modul.length() / 8 + tmp, 0x00);
-	signature += second.rightJustified(modul.length() / 8 + tmp, 0x00);
-
+	signature = joinSign(signParts.first, signParts.second, modul);
 	return true;
 }
 
+/// Takes (k, r) from the nonce pool when it has one ready, so only s is calculated here.
 QPair<big_int, big_int> SignatureInterface::calculateSignParts()
 {
 	big_int s = 0;
 	big_int r = 0;
 	do
 	{
-		big_int k = calculateK();
-		r = calculateR(k);
-		s = calculateS(k, r);
+		QPair<big_int, big_int> nonce;
+		if (!noncePool || !noncePool->isMadeFor(gostYear(), domainKey()) || !noncePool->take(nonce))
+		{
+			nonce = generateNonce();
+		}
+		r = nonce.second;
+		s = calculateS(nonce.first, r);
 	} while (s.is_null());
 	return qMakePair(r, s);
 }
 
+/// Message independent part of the signature: k and r != 0 for it.
+QPair<big_int, big_int> SignatureInterface::generateNonce()
+{
+	big_int k = 0;
+	big_int r = 0;
+	if (cryptoGenerator == 0 || !parametersAreSupported())
+	{
+		qDebug() << Q_FUNC_INFO << "Parameters aren't supported";
+		return qMakePair(k, r);
+	}
+	do
+	{
+		k = calculateK();
+		r = calculateR(k);
+	} while (r.is_null());
+	return qMakePair(k, r);
+}
+
+/// A pool made for other parameters is refused; the pool isn't owned by the signature.
+/** Changing the parameters later detaches the pool again. */
+void SignatureInterface::setNoncePool(NoncePool *pool)
+{
+	if (pool && !pool->isMadeFor(gostYear(), domainKey()))
+	{
+		qDebug() << Q_FUNC_INFO << "Nonce pool is made for other parameters";
+		pool = 0;
+	}
+	noncePool = pool;
+}
+
 big_int SignatureInterface::calculateK()
 {
 	return big_int::random_in_range(modul);
@@ -193,14 +234,12 @@ bool SignatureInterface::verifySign()
 
 big_int SignatureInterface::calculateSFromSign()
 {
-	quint8 tmp = (modul.length() % 8 == 0) ? 0 : 1;
-	return Function::big_intFromByteArray(signature.right(modul.length() / 8 + tmp));
+	return Function::big_intFromByteArray(signature.right(signPartLength(modul)));
 }
 
 big_int SignatureInterface::calculateRFromSign()
 {
-	quint8 tmp = (modul.length() % 8 == 0) ? 0 : 1;
-	return Function::big_intFromByteArray(signature.left(modul.length() / 8 + tmp));
+	return Function::big_intFromByteArray(signature.left(signPartLength(modul)));
 }
 
 big_int SignatureInterface::calculateZ1(const big_int &v, const big_int &s)
@@ -220,13 +259,52 @@ void SignatureInterface::generateNewParameters()
 		cryptoGenerator = CryptoGeneratorFactory::cryptoGeneratorByYear(gostYear());
 	}
 	cryptoGenerator->generate();
+	noncePool = 0;
 	generateNewKeys();
 }
 
+/// Length in bytes of each of r and s in a signature.
+int SignatureInterface::signPartLength(const big_int &modul)
+{
+	quint8 tmp = (modul.length() % 8 == 0) ? 0 : 1;
+	return modul.length() / 8 + tmp;
+}
+
+QByteArray SignatureInterface::joinSign(const big_int &r, const big_int &s, const big_int &modul)
+{
+	int partLength = signPartLength(modul);
+	QByteArray sign;
+	sign.reserve(2 * partLength);
+	sign += Function::big_intToByteArray(r).rightJustified(partLength, 0x00);
+	sign += Function::big_intToByteArray(s).rightJustified(partLength, 0x00);
+	return sign;
+}
+
+/// Returns false unless 0 < r < modul and 0 < s < modul.
+bool SignatureInterface::splitSign(const QByteArray &sign, const big_int &modul, big_int &r, big_int &s)
+{
+	if (sign.isEmpty())
+	{
+		return false;
+	}
+	int partLength = signPartLength(modul);
+	r = Function::big_intFromByteArray(sign.left(partLength));
+	s = Function::big_intFromByteArray(sign.right(partLength));
+	return !r.is_null() && r < modul && !s.is_null() && s < modul;
+}
+
+/// Message hash as a number modulo modul, 0 is replaced with 1 as the standard requires.
+big_int SignatureInterface::hashFromDigest(const QByteArray &digest, const big_int &modul)
+{
+	big_int e = mod(Function::big_intFromByteArray(digest), modul);
+	return e.is_null() ? big_int(1) : e;
+}
+
 bool SignatureInterface::mayBeSigned()
 {
 	return  (inputDevice->isOpen()) &&
 			(cryptoGenerator != 0) &&
+			(parametersAreSupported()) &&
 			(secretKeyIsCorrect());
 }
 
@@ -234,5 +312,11 @@ bool SignatureInterface::mayBeVerified()
 {
 	return  (!signature.isEmpty()) &&
 			(inputDevice->isOpen()) &&
-			(cryptoGenerator != 0);
+			(cryptoGenerator != 0) &&
+			(parametersAreSupported());
+}
+
+bool SignatureInterface::parametersAreSupported()
+{
+	return true;
 }
@@ -0,0 +1,179 @@
+#include "signaturepipeline.h"
+
+#include "signaturefactory.h"
+#include "signatureinterface.h"
+
+#include "hashfactory.h"
+
+#include <QIODevice>
+#include <QMutexLocker>
+
+SignatureJob::SignatureJob(QIODevice *input)
+	: input(input), result(false)
+{
+}
+
+class SignaturePipeline::HashWorker : public QThread
+{
+public:
+	HashWorker(SignaturePipeline *pipeline);
+
+protected:
+	void run();
+
+private:
+	SignaturePipeline *pipeline;
+};
+
+SignaturePipeline::HashWorker::HashWorker(SignaturePipeline *pipeline)
+	: pipeline(pipeline)
+{
+}
+
+void SignaturePipeline::HashWorker::run()
+{
+	int job;
+	while (pipeline->takeJob(job))
+	{
+		QIODevice *input = pipeline->batch[job].input;
+		if (input == 0 || (!input->isOpen() && !input->open(QIODevice::ReadOnly)))
+		{
+			pipeline->batch[job].result = false;
+			continue;
+		}
+		pipeline->putDigest(job, HashFactory::hash(pipeline->year, input, HashInterface::Base));
+	}
+	pipeline->hashWorkerDone();
+}
+
+class SignaturePipeline::SignWorker : public QThread
+{
+public:
+	SignWorker(SignaturePipeline *pipeline, SignatureInterface *signature);
+
+protected:
+	void run();
+
+private:
+	SignaturePipeline *pipeline;
+	SignatureInterface *signature;
+};
+
+SignaturePipeline::SignWorker::SignWorker(SignaturePipeline *pipeline, SignatureInterface *signature)
+	: pipeline(pipeline), signature(signature)
+{
+}
+
+void SignaturePipeline::SignWorker::run()
+{
+	QPair<int, QByteArray> digest;
+	while (pipeline->takeDigest(digest))
+	{
+		SignatureJob &job = pipeline->batch[digest.first];
+		job.signature = signature->signDigest(digest.second);
+		job.result = !job.signature.isEmpty();
+	}
+}
+
+SignaturePipeline::SignaturePipeline(int year, CryptoGeneratorInterface *parameters, const big_int &secretKey,
+									 int hashThreadCount, int signThreadCount, int queueCapacity)
+	: year(year), hashThreadCount(qMax(1, hashThreadCount)),
+	  batch(0), batchSize(0), nextJob(0), runningHashWorkers(0), capacity(qMax(1, queueCapacity))
+{
+	for (int i = 0; i < qMax(1, signThreadCount); i++)
+	{
+		SignatureInterface *signature = SignatureFactory::signatureWithParameters(year, parameters);
+		signature->setSecretKey(secretKey);
+		signatures.append(signature);
+	}
+}
+
+SignaturePipeline::~SignaturePipeline()
+{
+	qDeleteAll(signatures);
+	signatures.clear();
+}
+
+void SignaturePipeline::run(QVector<SignatureJob> &jobs)
+{
+	if (jobs.isEmpty())
+	{
+		return;
+	}
+
+	batch = jobs.data();
+	batchSize = jobs.size();
+	nextJob = 0;
+	runningHashWorkers = hashThreadCount;
+	digests.clear();
+
+	QList<QThread *> threads;
+	for (int i = 0; i < hashThreadCount; i++)
+	{
+		threads.append(new HashWorker(this));
+	}
+	for (int i = 0; i < signatures.size(); i++)
+	{
+		threads.append(new SignWorker(this, signatures[i]));
+	}
+	for (int i = 0; i < threads.size(); i++)
+	{
+		threads[i]->start();
+	}
+	for (int i = 0; i < threads.size(); i++)
+	{
+		threads[i]->wait();
+	}
+	qDeleteAll(threads);
+	batch = 0;
+}
+
+bool SignaturePipeline::takeJob(int &job)
+{
+	QMutexLocker locker(&mutex);
+	if (nextJob >= batchSize)
+	{
+		return false;
+	}
+	job = nextJob++;
+	return true;
+}
+
+/// Blocks the hash thread while the queue is full.
+void SignaturePipeline::putDigest(int job, const QByteArray &digest)
+{
+	QMutexLocker locker(&mutex);
+	while (digests.size() >= capacity)
+	{
+		notFull.wait(&mutex);
+	}
+	digests.append(qMakePair(job, digest));
+	notEmpty.wakeOne();
+}
+
+/// Blocks the sign thread until a digest is ready; false means all digests are signed.
+bool SignaturePipeline::takeDigest(QPair<int, QByteArray> &digest)
+{
+	QMutexLocker locker(&mutex);
+	while (digests.isEmpty() && runningHashWorkers > 0)
+	{
+		notEmpty.wait(&mutex);
+	}
+	if (digests.isEmpty())
+	{
+		return false;
+	}
+	digest = digests.takeFirst();
+	notFull.wakeOne();
+	return true;
+}
+
+void SignaturePipeline::hashWorkerDone()
+{
+	QMutexLocker locker(&mutex);
+	runningHashWorkers--;
+	if (runningHashWorkers == 0)
+	{
+		notEmpty.wakeAll();
+	}
+}
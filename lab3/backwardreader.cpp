@@ -0,0 +1,44 @@
+#include "backwardreader.h"
+
+#include <QIODevice>
+
+BackwardReader::BackwardReader(QIODevice *inputDevice, int blockSize)
+	: device(inputDevice), blockSize(blockSize)
+{
+	if (device->isSequential())
+	{
+		sequentialData = device->readAll();
+		sequentialBuffer.setBuffer(&sequentialData);
+		sequentialBuffer.open(QIODevice::ReadOnly);
+		device = &sequentialBuffer;
+	}
+	begin = device->pos();
+	total = qMax(qint64(0), device->size() - begin);
+	remaining = total;
+}
+
+qint64 BackwardReader::size() const
+{
+	return total;
+}
+
+QByteArray BackwardReader::readBlocks()
+{
+	qint64 length = qMin(remaining / blockSize * blockSize, chunkSize / blockSize * blockSize);
+	if (length <= 0)
+	{
+		return QByteArray();
+	}
+	remaining -= length;
+	device->seek(begin + remaining);
+	return device->read(length);
+}
+
+QByteArray BackwardReader::readRest()
+{
+	device->seek(begin);
+	QByteArray result = device->read(remaining);
+	remaining = 0;
+	device->seek(begin + total);
+	return result;
+}
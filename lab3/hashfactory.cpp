@@ -5,24 +5,28 @@
 
 #include <QDataStream>
 
-QByteArray HashFactory::hash(const int &year, QIODevice *inputDevice, const HashInterface::HashSize &size)
+HashInterface *HashFactory::algorithmByYear(int year)
 {
-	HashInterface *alghorithm;
 	switch (year)
 	{
 		case 2012:
 		{
-			alghorithm = new HashGost_2012();
-			break;
+			return new HashGost_2012();
 		}
 		case 1994:
 		default:
 		{
-			alghorithm = new HashGost_1994();
-			break;
+			return new HashGost_1994();
 		}
 	}
-	return alghorithm->hash(inputDevice, size);
+}
+
+QByteArray HashFactory::hash(const int &year, QIODevice *inputDevice, const HashInterface::HashSize &size)
+{
+	HashInterface *alghorithm = algorithmByYear(year);
+	QByteArray result = alghorithm->hash(inputDevice, size);
+	delete alghorithm;
+	return result;
 }
 
 QByteArray HashFactory::hash(const int &year, QByteArray data, const HashInterface::HashSize &size)
@@ -30,3 +34,24 @@ QByteArray HashFactory::hash(const int &year, QByteArray data, const HashInterfa
 	QDataStream stream(data);
 	return hash(year, stream.device(), size);
 }
+
+/// Many short messages at once, without a device or an algorithm object per message.
+QVector<QByteArray> HashFactory::hash(const int &year, const QVector<QByteArray> &messages,
+									  const HashInterface::HashSize &size)
+{
+	if (year == 2012)
+	{
+		return HashGost_2012::hashMany(messages, size);
+	}
+
+	QVector<QByteArray> result(messages.size());
+	HashInterface *alghorithm = algorithmByYear(year);
+	for (int i = 0; i < messages.size(); i++)
+	{
+		alghorithm->init(size);
+		alghorithm->update(messages[i].constData(), messages[i].size());
+		result[i] = alghorithm->final();
+	}
+	delete alghorithm;
+	return result;
+}
@@ -1,34 +1,84 @@
 #include "hashgost_1994.h"
 
+#include "backwardreader.h"
+
 HashGost_1994::HashGost_1994() : HashInterface()
 {
+	init(Base);
 }
 
 QByteArray HashGost_1994::hash(QIODevice *inputDevice, const HashSize &size)
 {
-	HashInterface::hash(inputDevice, size);
 	char result[size / 8];
 	memset(result, 0x00, size / 8);
 
-	qint64 tmp = data.length();
-	unsigned char additional[size / 8];
-	if (tmp >= size / 8)
+	BackwardReader reader(inputDevice, size / 8);
+	for (QByteArray chunk = reader.readBlocks(); !chunk.isEmpty(); chunk = reader.readBlocks())
 	{
-		while (tmp >= (size / 8))
+		for (int offset = chunk.length() - size / 8; offset >= 0; offset -= size / 8)
 		{
-			memcpy(additional, data.data() + tmp - size / 8, size / 8);
 			for (int i = 0; i < size / 8; i++)
 			{
-				result[i] = result[i] ^ additional[i];
+				result[i] = result[i] ^ chunk.at(offset + i);
 			}
-			tmp -= size / 8;
 		}
 	}
-	memset(additional, 0x00, size / 8);
-	memcpy(additional, data.data(), tmp);
-	for (int i = 0; i < size / 8; i++)
+
+	QByteArray rest = reader.readRest();
+	for (int i = 0; i < rest.length(); i++)
 	{
-		result[i] = result[i] ^ additional[i];
+		result[i] = result[i] ^ rest.at(i);
 	}
 	return QByteArray(result, size / 8);
 }
+
+void HashGost_1994::init(const HashSize &size)
+{
+	blockSize = size / 8;
+	messageLength = 0;
+	memset(head, 0x00, sizeof(head));
+	memset(folded, 0x00, sizeof(folded));
+}
+
+/// Bytes past the first block are folded by their offset from the message start.
+void HashGost_1994::update(const char *data, int dataLength)
+{
+	for (int i = 0; i < dataLength; i++, messageLength++)
+	{
+		if (messageLength < blockSize)
+		{
+			head[messageLength] = data[i];
+		}
+		else
+		{
+			folded[messageLength % blockSize] ^= data[i];
+		}
+	}
+}
+
+/// Gives the same result as hash(), whose blocks are aligned to the message end.
+QByteArray HashGost_1994::final()
+{
+	char result[64];
+	memset(result, 0x00, sizeof(result));
+
+	int rest = messageLength % blockSize;
+	int headLength = qMin<qint64>(messageLength, blockSize);
+	for (int i = 0; i < headLength; i++)
+	{
+		result[(i < rest) ? i : i - rest] ^= head[i];
+	}
+	for (int i = 0; i < blockSize; i++)
+	{
+		result[(i - rest + blockSize) % blockSize] ^= folded[i];
+	}
+
+	QByteArray digest(result, blockSize);
+	init(HashSize(blockSize * 8));
+	return digest;
+}
+
+bool HashGost_1994::finalMatchesHash() const
+{
+	return true;
+}
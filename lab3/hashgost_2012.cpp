@@ -1,187 +1,436 @@
 #include "hashgost_2012.h"
-#include "datagost_2012.h"
+#include "streebogtables.h"
+#include "streebogsimd.h"
+
+#include "backwardreader.h"
 
 HashGost_2012::HashGost_2012() : HashInterface()
 {
+	init(Base);
 }
 
 QByteArray HashGost_2012::hash(QIODevice *inputDevice, const HashInterface::HashSize &size)
 {
-	HashInterface::hash(inputDevice, size);
+	BackwardReader reader(inputDevice, 64);
 	switch (size)
 	{
 		case Base:
 		{
-			return hash_256(data);
+			return hash_256(reader);
 			break;
 		}
 		case DoubleBase:
 		default:
 		{
-			return hash_512(data);
+			return hash_512(reader);
 			break;
 		}
 	}
 }
 
-QByteArray HashGost_2012::hash_256(const QByteArray &data)
+QByteArray HashGost_2012::hash_256(BackwardReader &reader)
 {
-	QByteArray beginVector(64, char(0x01));
-
-	return hash_x(data, beginVector).mid(0, 32);
+	return hash_x(reader, Q_UINT64_C(0x0101010101010101)).mid(0, 32);
 }
 
-QByteArray HashGost_2012::hash_512(const QByteArray &data)
+QByteArray HashGost_2012::hash_512(BackwardReader &reader)
 {
-	QByteArray beginVector(64, char(0x00));
-
-	return hash_x(data, beginVector);
+	return hash_x(reader, 0);
 }
 
-QByteArray HashGost_2012::hash_x(const QByteArray &data, const QByteArray &beginVector)
+/// The message is taken from its last 64-byte block to the first one.
+QByteArray HashGost_2012::hash_x(BackwardReader &reader, quint64 beginWord)
 {
-	QByteArray N(64, 0x00);
-	QByteArray Summ(64, 0x00);
-	QByteArray n512(64, 0x00);
-	n512[62] = 0x02;
+	quint64 N[8] = {};
+	quint64 Summ[8] = {};
+	quint64 zero[8] = {};
+	quint64 h[8];
+	quint64 m[8];
+	for (int i = 0; i < 8; i++)
+	{
+		h[i] = beginWord;
+	}
 
-	QByteArray h = beginVector;
+	for (QByteArray chunk = reader.readBlocks(); !chunk.isEmpty(); chunk = reader.readBlocks())
+	{
+		for (int offset = chunk.length() - 64; offset >= 0; offset -= 64)
+		{
+			loadVector(m, chunk.constData() + offset);
 
-	QByteArray m(64, 0x00);
+			compression(N, h, m);
+			addVectorMod(N, 512);
+			addVectorMod(Summ, m);
+		}
+	}
 
+	QByteArray data = reader.readRest();
 	quint64 size = (data.length()) * 8;
 
-	while (size >= 512)
-	{
-		memcpy(m.data(), data.data() + size/8 - 63 - ( (size & 0x7) == 0 ), 64);
+	char block[64] = {};
+	memcpy(block + 63 - size/8 + ( (size & 0x7) == 0 ), data.data(), size/8 + 1 - ( (size & 0x7) == 0 ));
+	block[ 63 - size/8 ] |= (1 << (size & 0x7));
+	loadVector(m, block);
 
-		compression(N, h, m);
-		N = addVectorMod(N, n512);
-		Summ = addVectorMod(Summ, m);
+	compression(N, h, m);
+	addVectorMod(N, size);
+	addVectorMod(Summ, m);
 
-		size -= 512;
-	}
+	compression(zero, h, N);
+	compression(zero, h, Summ);
 
-	memset(m.data(),0,64);
-	memcpy(m.data() + 63 - size/8 + ( (size & 0x7) == 0 ), data.data(), size/8 + 1 - ( (size & 0x7) == 0 ));
-	m.data()[ 63 - size/8 ] |= (1 << (size & 0x7));
+	QByteArray result(64, 0x00);
+	storeVector(result.data(), h);
+	return result;
+}
 
-	compression(N, h, m);
-	n512[63] = size & 0xFF;
-	n512[62] = size >> 8;
-	N = addVectorMod(N, n512);
-	Summ = addVectorMod(Summ, m);
+/// One message of hashMany() with the input of its next compression.
+struct HashGost_2012::Lane
+{
+	int message;
+	/// Bytes of the message not yet compressed, counted from its beginning.
+	int rest;
+	/// 0 full blocks, 1 padded block, 2 length, 3 checksum.
+	int stage;
+	quint64 h[8];
+	quint64 N[8];
+	quint64 Summ[8];
+	quint64 key[8];
+	quint64 m[8];
+};
 
-	compression(QByteArray(64, 0x00), h, N);
-	compression(QByteArray(64, 0x00), h, Summ);
-	return h;
+QVector<QByteArray> HashGost_2012::hashMany(const QVector<QByteArray> &messages, const HashInterface::HashSize &size)
+{
+	QVector<QByteArray> result(messages.size());
+	quint64 beginWord = (size == Base) ? Q_UINT64_C(0x0101010101010101) : 0;
+
+	Lane lanes[laneCount];
+	int active = 0;
+	int next = 0;
+	while (true)
+	{
+		for (; active < laneCount && next < messages.size(); active++, next++)
+		{
+			Lane &lane = lanes[active];
+			lane.message = next;
+			lane.rest = messages[next].size();
+			lane.stage = 0;
+			for (int i = 0; i < 8; i++)
+			{
+				lane.h[i] = beginWord;
+				lane.N[i] = 0;
+				lane.Summ[i] = 0;
+			}
+		}
+		if (active == 0)
+		{
+			break;
+		}
+
+		for (int l = 0; l < active; l++)
+		{
+			Lane &lane = lanes[l];
+			const char *data = messages[lane.message].constData();
+			if (lane.stage == 0 && lane.rest < 64)
+			{
+				lane.stage = 1;
+			}
+			switch (lane.stage)
+			{
+				case 0:
+				{
+					loadVector(lane.m, data + lane.rest - 64);
+					memcpy(lane.key, lane.N, sizeof(lane.key));
+					break;
+				}
+				case 1:
+				{
+					char block[64] = {};
+					memcpy(block + 64 - lane.rest, data, lane.rest);
+					block[63 - lane.rest] = 0x01;
+					loadVector(lane.m, block);
+					memcpy(lane.key, lane.N, sizeof(lane.key));
+					break;
+				}
+				case 2:
+				{
+					memcpy(lane.m, lane.N, sizeof(lane.m));
+					memset(lane.key, 0x00, sizeof(lane.key));
+					break;
+				}
+				default:
+				{
+					memcpy(lane.m, lane.Summ, sizeof(lane.m));
+					memset(lane.key, 0x00, sizeof(lane.key));
+					break;
+				}
+			}
+		}
+
+		compressionLanes(lanes, active);
+
+		for (int l = 0; l < active; l++)
+		{
+			Lane &lane = lanes[l];
+			switch (lane.stage)
+			{
+				case 0:
+				{
+					addVectorMod(lane.N, 512);
+					addVectorMod(lane.Summ, lane.m);
+					lane.rest -= 64;
+					break;
+				}
+				case 1:
+				{
+					addVectorMod(lane.N, quint64(lane.rest) * 8);
+					addVectorMod(lane.Summ, lane.m);
+					lane.stage = 2;
+					break;
+				}
+				case 2:
+				{
+					lane.stage = 3;
+					break;
+				}
+				default:
+				{
+					QByteArray digest(64, 0x00);
+					storeVector(digest.data(), lane.h);
+					result[lane.message] = (size == Base) ? digest.left(32) : digest;
+					lanes[l] = lanes[--active];
+					l--;
+					break;
+				}
+			}
+		}
+	}
+	return result;
 }
 
-void HashGost_2012::compression(const QByteArray &N, QByteArray &h, const QByteArray &partMessage)
+/// One compression of every lane, two lanes at a time when the CPU allows.
+void HashGost_2012::compressionLanes(Lane *lanes, int count)
 {
-	QByteArray K(64, 0x00);
-	QByteArray t(64, 0x00);
-	K = xorVectorMod(N,h);
-	S(K);
-	P(K);
-	L(K);
-	t = E(K, partMessage);
-	t = xorVectorMod(t,h);
-	h = xorVectorMod(t,partMessage);
+	static const StreebogSimd::CompressionPairFunction pair = StreebogSimd::bestCompressionPair();
+	int l = 0;
+	if (pair)
+	{
+		for (; l + 1 < count; l += 2)
+		{
+			pair(lanes[l].key, lanes[l].h, lanes[l].m, lanes[l + 1].key, lanes[l + 1].h, lanes[l + 1].m);
+		}
+	}
+	for (; l < count; l++)
+	{
+		compression(lanes[l].key, lanes[l].h, lanes[l].m);
+	}
 }
 
+void HashGost_2012::init(const HashInterface::HashSize &size)
+{
+	contextSize = size;
+	quint64 beginWord = (size == Base) ? Q_UINT64_C(0x0101010101010101) : 0;
+	for (int i = 0; i < 8; i++)
+	{
+		state[i] = beginWord;
+		counter[i] = 0;
+		checksum[i] = 0;
+	}
+	pendingLength = 0;
+}
 
-QByteArray HashGost_2012::addVectorMod(const QByteArray &first, const QByteArray &second)
+/// Full blocks are compressed at once, only the incomplete tail is kept.
+void HashGost_2012::update(const char *data, int length)
 {
-	QByteArray result(64, 0x00);
-	int t = 0;
-	for(int i = 63; i >= 0; i--)
+	quint64 m[8];
+	if (pendingLength > 0)
 	{
-		t = quint8(first[i]) + quint8(second[i]) + (t >> 8);
-		result[i] = t & 0xFF;
+		int count = qMin(length, 64 - pendingLength);
+		memcpy(pending + pendingLength, data, count);
+		pendingLength += count;
+		data += count;
+		length -= count;
+		if (pendingLength < 64)
+		{
+			return;
+		}
+		loadVectorReversed(m, pending);
+		compression(counter, state, m);
+		addVectorMod(counter, 512);
+		addVectorMod(checksum, m);
+		pendingLength = 0;
 	}
-	return result;
+	for (; length >= 64; data += 64, length -= 64)
+	{
+		loadVectorReversed(m, data);
+		compression(counter, state, m);
+		addVectorMod(counter, 512);
+		addVectorMod(checksum, m);
+	}
+	memcpy(pending, data, length);
+	pendingLength = length;
 }
 
-QByteArray HashGost_2012::xorVectorMod(const QByteArray &first, const QByteArray &second)
+QByteArray HashGost_2012::final()
 {
+	quint64 zero[8] = {};
+	quint64 m[8];
+	memset(pending + pendingLength, 0x00, 64 - pendingLength);
+	pending[pendingLength] = 0x01;
+	loadVectorReversed(m, pending);
+
+	compression(counter, state, m);
+	addVectorMod(counter, pendingLength * 8);
+	addVectorMod(checksum, m);
+
+	compression(zero, state, counter);
+	compression(zero, state, checksum);
+
 	QByteArray result(64, 0x00);
-	const long long *A;
-	A = (long long*)(first.constData());
-	const long long *B;
-	B = (long long*)(second.constData());
-	unsigned long long *C;
-	C = (unsigned long long*)(result.data());
-	for(int i = 0; i < 8; i++)
+	storeVectorReversed(result.data(), state);
+	if (contextSize == Base)
 	{
-		C[i] = A[i] ^ B[i];
+		result = result.mid(32);
 	}
+	init(contextSize);
 	return result;
 }
 
-void HashGost_2012::S(QByteArray &K)
+bool HashGost_2012::finalMatchesHash() const
+{
+	return false;
+}
+
+void HashGost_2012::loadVector(quint64 *vector, const char *data)
 {
-	unsigned char *resultData = (unsigned char *)(K.data());
-	for(int i = 0; i < 64; i++)
+	const unsigned char *bytes = (const unsigned char *)(data);
+	for (int i = 0; i < 8; i++)
 	{
-		resultData[i] = Sbox[(quint8)(K[i])];
+		quint64 v = 0;
+		for (int k = 0; k < 8; k++)
+		{
+			v = (v << 8) | bytes[i * 8 + k];
+		}
+		vector[i] = v;
 	}
 }
 
-void HashGost_2012::P(QByteArray &K)
+void HashGost_2012::storeVector(char *data, const quint64 *vector)
 {
-	int i = 0;
-	unsigned char t[64] = {};
-	for(i=0;i<64;i++)
+	for (int i = 0; i < 8; i++)
 	{
-		t[i] = quint8(K[Tau[i]]);
+		for (int k = 0; k < 8; k++)
+		{
+			data[i * 8 + k] = char(vector[i] >> (7 - k) * 8);
+		}
 	}
-	memcpy(K.data(),t,64);
 }
 
-void HashGost_2012::L(QByteArray &K)
+/// Loads 64 bytes holding a little-endian number.
+void HashGost_2012::loadVectorReversed(quint64 *vector, const char *data)
 {
-	unsigned char * resultData = (unsigned char *)(K.data());
-	unsigned long long v = 0;
-	int i = 0, j = 0, k = 0;
-	for(i=0;i<8;i++)
+	const unsigned char *bytes = (const unsigned char *)(data);
+	for (int i = 0; i < 8; i++)
 	{
-		v=0;
-		for(k=0;k<8;k++)
+		quint64 v = 0;
+		for (int k = 7; k >= 0; k--)
 		{
-			for(j=0;j<8;j++)
-			{
-				if ((K[i*8+k] & (1<<(7-j))) != 0)
-					v ^= A[k*8+j];
-			}
+			v = (v << 8) | bytes[(7 - i) * 8 + k];
 		}
-		for(k=0;k<8;k++)
+		vector[i] = v;
+	}
+}
+
+void HashGost_2012::storeVectorReversed(char *data, const quint64 *vector)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		for (int k = 0; k < 8; k++)
 		{
-			resultData[i*8+k] = (v & ((unsigned long long)0xFF << (7-k)*8)) >> (7-k)*8;
+			data[(7 - i) * 8 + k] = char(vector[i] >> k * 8);
 		}
 	}
 }
 
-QByteArray HashGost_2012::E(QByteArray &K, const QByteArray &partMessage)
+/// Uses the vectorized compression when the CPU has one, the portable code otherwise.
+void HashGost_2012::compression(const quint64 *N, quint64 *h, const quint64 *partMessage)
 {
-	int i = 0;
-	QByteArray result(64, 0x00);
-	result = xorVectorMod(partMessage, K);
-	for(i=0;i<12;i++)
+	static const StreebogSimd::CompressionFunction vectorized = StreebogSimd::bestCompression();
+	if (vectorized)
+	{
+		vectorized(N, h, partMessage);
+		return;
+	}
+
+	quint64 K[8];
+	quint64 t[8];
+	xorVectorMod(K, N, h);
+	LPS(K);
+	E(t, K, partMessage);
+	for (int i = 0; i < 8; i++)
 	{
-		S(result);
-		P(result);
-		L(result);
+		h[i] ^= t[i] ^ partMessage[i];
+	}
+}
+
+void HashGost_2012::addVectorMod(quint64 *result, const quint64 *value)
+{
+	quint64 carry = 0;
+	for (int i = 7; i >= 0; i--)
+	{
+		quint64 sum = result[i] + value[i];
+		quint64 nextCarry = (sum < result[i]) ? 1 : 0;
+		sum += carry;
+		nextCarry += (sum < carry) ? 1 : 0;
+		result[i] = sum;
+		carry = nextCarry;
+	}
+}
+
+void HashGost_2012::addVectorMod(quint64 *result, quint64 value)
+{
+	for (int i = 7; i >= 0 && value != 0; i--)
+	{
+		result[i] += value;
+		value = (result[i] < value) ? 1 : 0;
+	}
+}
+
+void HashGost_2012::xorVectorMod(quint64 *result, const quint64 *first, const quint64 *second)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		result[i] = first[i] ^ second[i];
+	}
+}
+
+void HashGost_2012::LPS(quint64 *K)
+{
+	const quint64 (*table)[256] = StreebogTables::instance().lps;
+	quint64 v[8];
+	for (int i = 0; i < 8; i++)
+	{
+		int shift = 56 - 8 * i;
+		v[i] = table[0][quint8(K[0] >> shift)] ^ table[1][quint8(K[1] >> shift)] ^
+			   table[2][quint8(K[2] >> shift)] ^ table[3][quint8(K[3] >> shift)] ^
+			   table[4][quint8(K[4] >> shift)] ^ table[5][quint8(K[5] >> shift)] ^
+			   table[6][quint8(K[6] >> shift)] ^ table[7][quint8(K[7] >> shift)];
+	}
+	memcpy(K, v, sizeof(v));
+}
+
+void HashGost_2012::E(quint64 *result, quint64 *K, const quint64 *partMessage)
+{
+	xorVectorMod(result, partMessage, K);
+	for (int i = 0; i < 12; i++)
+	{
+		LPS(result);
 		KeySchedule(K, i);
-		result = xorVectorMod(result, K);
+		xorVectorMod(result, result, K);
 	}
-	return result;
 }
 
-void HashGost_2012::KeySchedule(QByteArray &K, const int &iteration)
+void HashGost_2012::KeySchedule(quint64 *K, int iteration)
 {
-	K = xorVectorMod(K, QByteArray((char*)(C[iteration]), 64));
-	S(K);
-	P(K);
-	L(K);
+	xorVectorMod(K, K, StreebogTables::instance().roundConstants[iteration]);
+	LPS(K);
 }
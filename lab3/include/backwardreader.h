@@ -0,0 +1,38 @@
+#ifndef BACKWARDREADER_H
+#define BACKWARDREADER_H
+
+#include <QBuffer>
+#include <QByteArray>
+
+class QIODevice;
+
+/// Reads the unread part of a device in chunks from its end to its beginning.
+/** Both GOST hashes process the message from the last block to the first,
+	so a random access device is read backwards with a bounded buffer. A
+	sequential device can't be read this way and is read completely first. */
+class BackwardReader
+{
+public:
+	BackwardReader(QIODevice *inputDevice, int blockSize);
+
+	qint64 size() const;
+
+	/// Next whole blocks before the already read ones, empty when none are left.
+	QByteArray readBlocks();
+	/// The leading part shorter than a block; the device is left at its end.
+	QByteArray readRest();
+
+private:
+	QIODevice *device;
+	QByteArray sequentialData;
+	QBuffer sequentialBuffer;
+
+	int blockSize;
+	qint64 begin;
+	qint64 total;
+	qint64 remaining;
+
+	static const qint64 chunkSize = 1 << 20;
+};
+
+#endif // BACKWARDREADER_H
@@ -2,6 +2,7 @@
 #define HASHFACTORY_H
 
 #include <QByteArray>
+#include <QVector>
 #include <hashinterface.h>
 
 class QIODevice;
@@ -9,9 +10,13 @@ class QIODevice;
 class HashFactory
 {
 public:
+	static HashInterface *algorithmByYear(int year);
+
 	static QByteArray hash(const int &year, QIODevice *inputDevice,
 						   const HashInterface::HashSize &size = HashInterface::Base);
 	static QByteArray hash(const int &year, QByteArray data,
 							const HashInterface::HashSize &size = HashInterface::Base);
+	static QVector<QByteArray> hash(const int &year, const QVector<QByteArray> &messages,
+									const HashInterface::HashSize &size = HashInterface::Base);
 };
 #endif // HASHFACTORY_H
@@ -9,6 +9,18 @@ public:
 	HashGost_1994();
 
 	virtual QByteArray hash(QIODevice *inputDevice, const HashSize &size);
+
+	virtual void init(const HashSize &size);
+	virtual void update(const char *data, int length);
+	virtual QByteArray final();
+	virtual bool finalMatchesHash() const;
+
+private:
+	int blockSize;
+	qint64 messageLength;
+	/// The first block is kept apart, the final alignment depends on the message length.
+	char head[64];
+	char folded[64];
 };
 
 #endif // HASHGOST_1994_H
@@ -3,6 +3,10 @@
 
 #include <hashinterface.h>
 
+#include <QVector>
+
+class BackwardReader;
+
 class HashGost_2012 : public HashInterface
 {
 public:
@@ -10,22 +14,52 @@ public:
 
 	virtual QByteArray hash(QIODevice *inputDevice, const HashSize &size);
 
+	/// Streaming context in the byte order of GOST R 34.11-2012 itself.
+	/** The message is read from its first byte as a little-endian number and
+		the digest is little-endian too. hash() reads the bytes as a big-endian
+		number from the end, so final() gives the reversed hash() of the
+		reversed message. */
+	virtual void init(const HashSize &size);
+	virtual void update(const char *data, int length);
+	virtual QByteArray final();
+	virtual bool finalMatchesHash() const;
+
+	/// Hashes independent messages in interleaved lanes, the results are the same as of hash().
+	static QVector<QByteArray> hashMany(const QVector<QByteArray> &messages, const HashSize &size);
+
 private:
-	QByteArray hash_x(const QByteArray &data, const QByteArray &beginVector);
-	QByteArray hash_256(const QByteArray &data);
-	QByteArray hash_512(const QByteArray &data);
+	struct Lane;
+
+	static const int laneCount = 4;
+	static void compressionLanes(Lane *lanes, int count);
+
+	QByteArray hash_x(BackwardReader &reader, quint64 beginWord);
+	QByteArray hash_256(BackwardReader &reader);
+	QByteArray hash_512(BackwardReader &reader);
+
+	/// 512-bit vectors are eight words, word 0 holds the most significant bytes.
+	static void loadVector(quint64 *vector, const char *data);
+	static void storeVector(char *data, const quint64 *vector);
+	static void loadVectorReversed(quint64 *vector, const char *data);
+	static void storeVectorReversed(char *data, const quint64 *vector);
+
+	static void compression(const quint64 *N, quint64 *h, const quint64 *partMessage);
+	static void addVectorMod(quint64 *result, const quint64 *value);
+	static void addVectorMod(quint64 *result, quint64 value);
+	static void xorVectorMod(quint64 *result, const quint64 *first, const quint64 *second);
 
-	void compression(const QByteArray &N, QByteArray &h, const QByteArray &partMessage);
-	QByteArray addVectorMod(const QByteArray &first, const QByteArray &second);
-	QByteArray xorVectorMod(const QByteArray &first, const QByteArray &second);
+	static void LPS(quint64 *K);
 
-	void S(QByteArray &K);
-	void P(QByteArray &K);
-	void L(QByteArray &K);
+	static void E(quint64 *result, quint64 *K, const quint64 *partMessage);
 
-	QByteArray E(QByteArray &K, const QByteArray &partMessage);
+	static void KeySchedule(quint64 *K, int iteration);
 
-	void KeySchedule(QByteArray &K, const int &iteration);
+	HashSize contextSize;
+	quint64 state[8];
+	quint64 counter[8];
+	quint64 checksum[8];
+	char pending[64];
+	int pendingLength;
 };
 
 #endif // HASHGOST_2012_H
@@ -18,6 +18,17 @@ public:
 
 	virtual QByteArray hash(QIODevice *inputDevice, const HashSize &size);
 
+	/// Streaming hashing: init(), then update() any number of times, then final().
+	/** Only one pending block is kept, so the memory doesn't depend on the
+		length of the message. final() isn't always the digest hash() gives for
+		the same bytes: the 2012 context follows the byte order of the standard
+		while hash(), and so the signatures, read the message reversed. Check
+		finalMatchesHash() before mixing the two; the signing path uses hash(). */
+	virtual void init(const HashSize &size) = 0;
+	virtual void update(const char *data, int length) = 0;
+	virtual QByteArray final() = 0;
+	virtual bool finalMatchesHash() const = 0;
+
 protected:
 	QByteArray data;
 };
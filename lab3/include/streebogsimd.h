@@ -0,0 +1,35 @@
+#ifndef STREEBOGSIMD_H
+#define STREEBOGSIMD_H
+
+#include <QtGlobal>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define STREEBOG_SIMD
+#endif
+
+/// Vectorized Streebog compression function for x86-64, chosen by CPUID at run time.
+/** The state and round keys are kept in SSE registers for the xor steps and
+	LPS reads its table indices straight from them. The 512-bit additions are
+	left to the portable code, their carry chain doesn't vectorize. A 256-bit
+	AVX2 state was measured slower, the lookups dominate and splitting the
+	registers for them costs more than the wider xor saves. */
+class StreebogSimd
+{
+public:
+	typedef void (*CompressionFunction)(const quint64 *N, quint64 *h, const quint64 *partMessage);
+	typedef void (*CompressionPairFunction)(const quint64 *firstN, quint64 *firstH, const quint64 *firstMessage,
+											const quint64 *secondN, quint64 *secondH, const quint64 *secondMessage);
+
+	/// Fastest compression the CPU supports, 0 when only the portable one can be used.
+	static CompressionFunction bestCompression();
+	/// Compression of two independent states at once for multi-buffer hashing, 0 if there is none.
+	static CompressionPairFunction bestCompressionPair();
+
+#ifdef STREEBOG_SIMD
+	static void compressionSse41(const quint64 *N, quint64 *h, const quint64 *partMessage);
+	static void compressionPairSse41(const quint64 *firstN, quint64 *firstH, const quint64 *firstMessage,
+									 const quint64 *secondN, quint64 *secondH, const quint64 *secondMessage);
+#endif
+};
+
+#endif // STREEBOGSIMD_H
@@ -0,0 +1,21 @@
+#ifndef STREEBOGTABLES_H
+#define STREEBOGTABLES_H
+
+#include <QtGlobal>
+
+/// Constant tables of the Streebog compression function in the word layout of its state.
+/** A 512-bit vector is eight words, word 0 holds the most significant bytes.
+	After S and P byte k of output row i is Sbox[K[8 * k + i]], and L turns
+	it into a fixed 64-bit contribution to row i, so each output row is the
+	xor of eight lookups in lps. */
+struct StreebogTables
+{
+	StreebogTables();
+
+	quint64 lps[8][256];
+	quint64 roundConstants[12][8];
+
+	static const StreebogTables &instance();
+};
+
+#endif // STREEBOGTABLES_H
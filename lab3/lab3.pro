@@ -25,14 +25,20 @@ SOURCES += \
     hashinterface.cpp \
     hashfactory.cpp \
     hashgost_1994.cpp \
-    hashgost_2012.cpp
+    hashgost_2012.cpp \
+    backwardreader.cpp \
+    streebogtables.cpp \
+    streebogsimd.cpp
 
 HEADERS += \
     include/hashinterface.h \
     include/hashfactory.h \
     include/hashgost_1994.h \
     include/hashgost_2012.h \
-    include/datagost_2012.h
+    include/datagost_2012.h \
+    include/backwardreader.h \
+    include/streebogtables.h \
+    include/streebogsimd.h
 
 INCLUDEPATH += $$PWD/include
 
@@ -7,6 +7,94 @@
 #include <hashinterface.h>
 #include <hashfactory.h>
 
+QByteArray reversed(const QByteArray &data)
+{
+	QByteArray result(data.size(), 0);
+	for (int i = 0; i < data.size(); i++)
+	{
+		result[i] = data.at(data.size() - 1 - i);
+	}
+	return result;
+}
+
+QByteArray testMessage(int length)
+{
+	QByteArray result(length, 0);
+	for (int i = 0; i < length; i++)
+	{
+		result[i] = char((i * 131 + length) & 0xff);
+	}
+	return result;
+}
+
+/// Feeds every message to update() in pieces of several lengths and compares final() with hash().
+/** When finalMatchesHash() is false (2012), final() of M is the reversed hash() of the reversed M. */
+bool checkFinal(int year)
+{
+	const int lengths[] = {0, 1, 31, 32, 63, 64, 65, 200, 1000};
+	const int pieces[] = {1, 7, 64, 1000};
+	const HashInterface::HashSize sizes[] = {HashInterface::Base, HashInterface::DoubleBase};
+
+	HashInterface *algorithm = HashFactory::algorithmByYear(year);
+	bool result = true;
+	for (unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+	{
+		QByteArray message = testMessage(lengths[l]);
+		for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+		{
+			QByteArray expected = algorithm->finalMatchesHash()
+					? HashFactory::hash(year, message, sizes[s])
+					: reversed(HashFactory::hash(year, reversed(message), sizes[s]));
+			for (unsigned int p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++)
+			{
+				algorithm->init(sizes[s]);
+				for (int offset = 0; offset < message.size(); offset += pieces[p])
+				{
+					algorithm->update(message.constData() + offset, qMin(pieces[p], message.size() - offset));
+				}
+				result = result && (algorithm->final() == expected);
+			}
+		}
+	}
+	delete algorithm;
+	return result;
+}
+
+/// Compares the multi-lane HashFactory::hash() of a message list with hashing one message at a time.
+bool checkHashMany(int year)
+{
+	QVector<QByteArray> messages;
+	for (int length = 0; length < 300; length += 13)
+	{
+		messages.append(testMessage(length));
+	}
+
+	bool result = true;
+	const HashInterface::HashSize sizes[] = {HashInterface::Base, HashInterface::DoubleBase};
+	for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		QVector<QByteArray> digests = HashFactory::hash(year, messages, sizes[s]);
+		result = result && (digests.size() == messages.size());
+		for (int i = 0; result && i < messages.size(); i++)
+		{
+			result = (digests[i] == HashFactory::hash(year, messages[i], sizes[s]));
+		}
+	}
+	return result;
+}
+
+/// RFC 6986 example M1, printed in the byte order of the standard.
+QByteArray finalOfM1(const HashInterface::HashSize &size)
+{
+	QByteArray m1 = "012345678901234567890123456789012345678901234567890123456789012";
+	HashInterface *algorithm = HashFactory::algorithmByYear(2012);
+	algorithm->init(size);
+	algorithm->update(m1.constData(), m1.size());
+	QByteArray result = reversed(algorithm->final());
+	delete algorithm;
+	return result;
+}
+
 int main(int argc, char *argv[])
 {
 	QCoreApplication a(argc, argv);
@@ -25,5 +113,13 @@ int main(int argc, char *argv[])
 			 << "508f7e553...........d29d";
 	delete t;
 
+	qDebug() << "final 1994" << checkFinal(1994) << "final 2012" << checkFinal(2012);
+	qDebug() << "many 1994" << checkHashMany(1994) << "many 2012" << checkHashMany(2012);
+	qDebug() << finalOfM1(HashInterface::DoubleBase).toHex() << "\n"
+			 << "486f64c1917879417fef082b3381a4e211c324f074654c38823a7b76f830ad00"
+				"fa1fbae42b1285c0352f227524bc9ab16254288dd6863dccd5b9f54a1ad0541b";
+	qDebug() << finalOfM1(HashInterface::Base).toHex() << "\n"
+			 << "00557be5e584fd52a449b16b0251d05d27f94ab76cbaa6da890b59d8ef1e159d";
+
 	return 0;
 }
@@ -0,0 +1,159 @@
+#include "streebogsimd.h"
+#include "streebogtables.h"
+
+#ifdef STREEBOG_SIMD
+
+#include <immintrin.h>
+
+/// 512-bit vector in four registers, register r holds words 2r and 2r + 1.
+struct SseVector
+{
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+};
+
+__attribute__((target("sse4.1")))
+static inline SseVector loadSse(const quint64 *vector)
+{
+	const __m128i *p = (const __m128i *)(vector);
+	SseVector result = {_mm_loadu_si128(p), _mm_loadu_si128(p + 1), _mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)};
+	return result;
+}
+
+__attribute__((target("sse4.1")))
+static inline void storeSse(quint64 *vector, const SseVector &value)
+{
+	__m128i *p = (__m128i *)(vector);
+	_mm_storeu_si128(p, value.x0);
+	_mm_storeu_si128(p + 1, value.x1);
+	_mm_storeu_si128(p + 2, value.x2);
+	_mm_storeu_si128(p + 3, value.x3);
+}
+
+__attribute__((target("sse4.1")))
+static inline SseVector xorSse(const SseVector &first, const SseVector &second)
+{
+	SseVector result = {_mm_xor_si128(first.x0, second.x0), _mm_xor_si128(first.x1, second.x1),
+						_mm_xor_si128(first.x2, second.x2), _mm_xor_si128(first.x3, second.x3)};
+	return result;
+}
+
+/// Two LPS output rows, 7 - 2 * J and 6 - 2 * J, from the 16-bit lanes J and J + 4.
+template <int J>
+__attribute__((target("sse4.1")))
+static inline void lpsRows(const SseVector &x, const quint64 (*table)[256], quint64 *v)
+{
+	unsigned int a0 = _mm_extract_epi16(x.x0, J);
+	unsigned int b0 = _mm_extract_epi16(x.x0, J + 4);
+	unsigned int a1 = _mm_extract_epi16(x.x1, J);
+	unsigned int b1 = _mm_extract_epi16(x.x1, J + 4);
+	unsigned int a2 = _mm_extract_epi16(x.x2, J);
+	unsigned int b2 = _mm_extract_epi16(x.x2, J + 4);
+	unsigned int a3 = _mm_extract_epi16(x.x3, J);
+	unsigned int b3 = _mm_extract_epi16(x.x3, J + 4);
+	v[7 - 2 * J] = table[0][a0 & 0xFF] ^ table[1][b0 & 0xFF] ^ table[2][a1 & 0xFF] ^ table[3][b1 & 0xFF] ^
+				   table[4][a2 & 0xFF] ^ table[5][b2 & 0xFF] ^ table[6][a3 & 0xFF] ^ table[7][b3 & 0xFF];
+	v[6 - 2 * J] = table[0][a0 >> 8] ^ table[1][b0 >> 8] ^ table[2][a1 >> 8] ^ table[3][b1 >> 8] ^
+				   table[4][a2 >> 8] ^ table[5][b2 >> 8] ^ table[6][a3 >> 8] ^ table[7][b3 >> 8];
+}
+
+__attribute__((target("sse4.1")))
+static inline void lpsSse(SseVector &x, const quint64 (*table)[256])
+{
+	quint64 v[8];
+	lpsRows<0>(x, table, v);
+	lpsRows<1>(x, table, v);
+	lpsRows<2>(x, table, v);
+	lpsRows<3>(x, table, v);
+	x.x0 = _mm_insert_epi64(_mm_cvtsi64_si128(v[0]), v[1], 1);
+	x.x1 = _mm_insert_epi64(_mm_cvtsi64_si128(v[2]), v[3], 1);
+	x.x2 = _mm_insert_epi64(_mm_cvtsi64_si128(v[4]), v[5], 1);
+	x.x3 = _mm_insert_epi64(_mm_cvtsi64_si128(v[6]), v[7], 1);
+}
+
+__attribute__((target("sse4.1")))
+void StreebogSimd::compressionSse41(const quint64 *N, quint64 *h, const quint64 *partMessage)
+{
+	const StreebogTables &tables = StreebogTables::instance();
+	SseVector state = loadSse(h);
+	SseVector m = loadSse(partMessage);
+
+	SseVector K = xorSse(loadSse(N), state);
+	lpsSse(K, tables.lps);
+	SseVector t = xorSse(m, K);
+	for (int i = 0; i < 12; i++)
+	{
+		lpsSse(t, tables.lps);
+		K = xorSse(K, loadSse(tables.roundConstants[i]));
+		lpsSse(K, tables.lps);
+		t = xorSse(t, K);
+	}
+
+	storeSse(h, xorSse(state, xorSse(t, m)));
+}
+
+/// Two independent compressions with their LPS steps interleaved.
+__attribute__((target("sse4.1")))
+void StreebogSimd::compressionPairSse41(const quint64 *firstN, quint64 *firstH, const quint64 *firstMessage,
+										const quint64 *secondN, quint64 *secondH, const quint64 *secondMessage)
+{
+	const StreebogTables &tables = StreebogTables::instance();
+	SseVector firstState = loadSse(firstH);
+	SseVector secondState = loadSse(secondH);
+	SseVector firstM = loadSse(firstMessage);
+	SseVector secondM = loadSse(secondMessage);
+
+	SseVector firstK = xorSse(loadSse(firstN), firstState);
+	SseVector secondK = xorSse(loadSse(secondN), secondState);
+	lpsSse(firstK, tables.lps);
+	lpsSse(secondK, tables.lps);
+	SseVector firstT = xorSse(firstM, firstK);
+	SseVector secondT = xorSse(secondM, secondK);
+	for (int i = 0; i < 12; i++)
+	{
+		SseVector c = loadSse(tables.roundConstants[i]);
+		lpsSse(firstT, tables.lps);
+		lpsSse(secondT, tables.lps);
+		firstK = xorSse(firstK, c);
+		secondK = xorSse(secondK, c);
+		lpsSse(firstK, tables.lps);
+		lpsSse(secondK, tables.lps);
+		firstT = xorSse(firstT, firstK);
+		secondT = xorSse(secondT, secondK);
+	}
+
+	storeSse(firstH, xorSse(firstState, xorSse(firstT, firstM)));
+	storeSse(secondH, xorSse(secondState, xorSse(secondT, secondM)));
+}
+
+static bool hasSse41()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.1");
+}
+
+#endif
+
+StreebogSimd::CompressionFunction StreebogSimd::bestCompression()
+{
+#ifdef STREEBOG_SIMD
+	if (hasSse41())
+	{
+		return &StreebogSimd::compressionSse41;
+	}
+#endif
+	return 0;
+}
+
+StreebogSimd::CompressionPairFunction StreebogSimd::bestCompressionPair()
+{
+#ifdef STREEBOG_SIMD
+	if (hasSse41())
+	{
+		return &StreebogSimd::compressionPairSse41;
+	}
+#endif
+	return 0;
+}
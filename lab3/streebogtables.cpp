@@ -0,0 +1,39 @@
+#include "streebogtables.h"
+#include "datagost_2012.h"
+
+StreebogTables::StreebogTables()
+{
+	for (int k = 0; k < 8; k++)
+	{
+		for (int x = 0; x < 256; x++)
+		{
+			quint64 v = 0;
+			for (int j = 0; j < 8; j++)
+			{
+				if ((Sbox[x] & (1 << (7 - j))) != 0)
+				{
+					v ^= A[k * 8 + j];
+				}
+			}
+			lps[k][x] = v;
+		}
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		for (int j = 0; j < 8; j++)
+		{
+			quint64 v = 0;
+			for (int k = 0; k < 8; k++)
+			{
+				v = (v << 8) | C[i][j * 8 + k];
+			}
+			roundConstants[i][j] = v;
+		}
+	}
+}
+
+const StreebogTables &StreebogTables::instance()
+{
+	static const StreebogTables tables;
+	return tables;
+}